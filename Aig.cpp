@@ -0,0 +1,235 @@
+#include <cassert>
+#include <algorithm>
+#include <unordered_set>
+
+#include "Aig.h"
+
+const int Aig::LIT_FALSE;
+const int Aig::LIT_TRUE;
+
+Aig::Aig(const Model& model)
+	: _name(model.name()), _num_primary_inputs(model.inputs().size()), _num_hits(0)
+{
+	// Constant node
+	_fanin0.push_back(LIT_FALSE);
+	_fanin1.push_back(LIT_FALSE);
+
+	unordered_map<string, int> literals;
+	for (const auto& input : model.inputs()) {
+		literals.emplace(input, add_input(input));
+	}
+	for (const auto& latch : model.latches()) {
+		literals.emplace(latch.output(), add_input(latch.output()));
+	}
+
+	unordered_map<string, const Gate*> drivers;
+	for (const auto& gate : model.gates()) {
+		drivers.emplace(gate.name(), &gate);
+	}
+
+	// Only logic reachable from the outputs and latch inputs is converted
+	for (const auto& output : model.outputs()) {
+		_outputs.push_back(make_pair(output, convert(output, model, drivers, literals)));
+	}
+	for (const auto& latch : model.latches()) {
+		_latches.push_back(latch);
+		_next_states.push_back(make_pair(latch.input(), convert(latch.input(), model, drivers, literals)));
+	}
+}
+
+int Aig::add_input(const string& name)
+{
+	assert(_fanin0.size() == _inputs.size() + 1 && "Inputs precede AND nodes");
+	_inputs.push_back(name);
+	_fanin0.push_back(LIT_FALSE);
+	_fanin1.push_back(LIT_FALSE);
+	return 2 * _inputs.size();
+}
+
+int Aig::convert(const string& signal, const Model& model, unordered_map<string, const Gate*>& drivers,
+		unordered_map<string, int>& literals)
+{
+	const auto itr = literals.find(signal);
+	if (itr != literals.end()) {
+		return itr->second;
+	}
+
+	const auto driver = drivers.find(signal);
+	if (driver == drivers.end()) {
+		cout << "Undriven signal: " << signal << endl;
+		literals.emplace(signal, LIT_FALSE);
+		return LIT_FALSE;
+	}
+
+	const Gate& gate = *driver->second;
+	int result = LIT_FALSE;
+	if (gate.is_constant()) {
+		result = gate.constant() ? LIT_TRUE : LIT_FALSE;
+	}
+	else {
+		vector<int> cube;
+		for (const auto& row : gate.rows()) {
+			cube.clear();
+			for (const auto& literal : row) {
+				if (literal[0] == '-') {
+					cube.push_back(negate(convert(literal.substr(1), model, drivers, literals)));
+				}
+				else {
+					cube.push_back(convert(literal, model, drivers, literals));
+				}
+			}
+			// Sorted chains share common prefixes across cubes and gates
+			std::sort(cube.begin(), cube.end());
+
+			int product = LIT_TRUE;
+			for (const auto& literal : cube) {
+				product = make_and(product, literal);
+			}
+			result = make_or(result, product);
+		}
+		if (gate.output()[0] == '-') {
+			result = negate(result);
+		}
+	}
+
+	literals.emplace(signal, result);
+	return result;
+}
+
+int Aig::make_and(int x, int y)
+{
+	// Constant propagation and trivial cases
+	if (x == LIT_FALSE || y == LIT_FALSE || x == negate(y)) {
+		return LIT_FALSE;
+	}
+	if (x == LIT_TRUE || x == y) {
+		return y;
+	}
+	if (y == LIT_TRUE) {
+		return x;
+	}
+
+	if (x > y) {
+		std::swap(x, y);
+	}
+	uint64_t key = (static_cast<uint64_t>(x) << 32) | static_cast<uint32_t>(y);
+	const auto itr = _table.find(key);
+	if (itr != _table.end()) {
+		_num_hits++;
+		return 2 * itr->second;
+	}
+
+	int node = _fanin0.size();
+	_fanin0.push_back(x);
+	_fanin1.push_back(y);
+	_table.emplace(key, node);
+	return 2 * node;
+}
+
+Model Aig::to_model() const
+{
+	Model model;
+	model.create_arena();
+	model.name() = _name;
+	model.inputs().assign(_inputs.begin(), _inputs.begin() + _num_primary_inputs);
+
+	vector<pair<string, int> > roots(_outputs);
+	roots.insert(roots.end(), _next_states.begin(), _next_states.end());
+
+	// Mark the nodes reachable from the roots
+	vector<bool> used(num_nodes(), false);
+	vector<int> todo;
+	for (const auto& root : roots) {
+		todo.push_back(node(root.second));
+	}
+	while (!todo.empty()) {
+		int n = todo.back();
+		todo.pop_back();
+		if (used[n]) {
+			continue;
+		}
+		used[n] = true;
+		if (is_and(n)) {
+			todo.push_back(node(_fanin0[n]));
+			todo.push_back(node(_fanin1[n]));
+		}
+	}
+
+	vector<string> names(num_nodes());
+	for (size_t i = 0; i < _inputs.size(); i++) {
+		names[i + 1] = _inputs[i];
+	}
+	// A root driven by a positive AND node names that node directly
+	vector<bool> named(roots.size(), false);
+	for (size_t i = 0; i < roots.size(); i++) {
+		int n = node(roots[i].second);
+		if (is_and(n) && !is_complement(roots[i].second) && names[n].empty()) {
+			names[n] = roots[i].first;
+			named[i] = true;
+		}
+	}
+	for (int n = 0; n < num_nodes(); n++) {
+		if (names[n].empty() && is_and(n) && used[n]) {
+			names[n] = "aig$" + to_string(n);
+		}
+	}
+
+	auto literal_name = [&names](int literal) {
+		return is_complement(literal) ? "-" + names[node(literal)] : names[node(literal)];
+	};
+
+	// AND nodes are numbered in topological order
+	for (int n = 0; n < num_nodes(); n++) {
+		if (!is_and(n) || !used[n]) {
+			continue;
+		}
+		Gate& gate = model.add_gate();
+		gate.name() = names[n];
+		gate.output() = names[n];
+		gate.constant() = false;
+		gate.inputs().push_back(names[node(_fanin0[n])]);
+		gate.inputs().push_back(names[node(_fanin1[n])]);
+		Gate::Signals& row = gate.add_row();
+		row.push_back(literal_name(_fanin0[n]));
+		row.push_back(literal_name(_fanin1[n]));
+	}
+
+	unordered_set<string> emitted;
+	for (size_t i = 0; i < roots.size(); i++) {
+		const string& name = roots[i].first;
+		int literal = roots[i].second;
+		if (named[i] || (!is_complement(literal) && names[node(literal)] == name)
+				|| !emitted.insert(name).second) {
+			continue;
+		}
+
+		Gate& gate = model.add_gate();
+		gate.name() = name;
+		gate.output() = name;
+		if (node(literal) == 0) {
+			gate.constant() = (literal == LIT_TRUE);
+		}
+		else {
+			gate.constant() = false;
+			gate.inputs().push_back(names[node(literal)]);
+			gate.add_row().push_back(literal_name(literal));
+		}
+	}
+
+	for (const auto& output : _outputs) {
+		model.outputs().push_back(output.first);
+	}
+	for (const auto& latch : _latches) {
+		model.add_latch() = latch;
+	}
+
+	return model;
+}
+
+void Aig::output_status(ostream& out) const
+{
+	out << "AIG: " << _name << endl;
+	out << "# Inputs: " << _inputs.size() << endl;
+	out << "# ANDs: " << num_ands() << endl;
+	out << "# Strash Hits: " << _num_hits << endl;
+}
@@ -0,0 +1,97 @@
+#ifndef AIG_H_
+#define AIG_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Model.h"
+
+using namespace std;
+
+// Structurally hashed and-inverter graph.
+// Node 0 is the constant false, a literal is 2 * node + complement.
+class Aig
+{
+public:
+	static const int LIT_FALSE = 0;
+	static const int LIT_TRUE = 1;
+
+private:
+	string _name;
+	vector<int> _fanin0;
+	vector<int> _fanin1;
+	unordered_map<uint64_t, int> _table;
+
+	// Primary inputs followed by latch outputs
+	vector<string> _inputs;
+	int _num_primary_inputs;
+	vector<pair<string, int> > _outputs;
+	vector<Latch> _latches;
+	// Latch input signals and their literals
+	vector<pair<string, int> > _next_states;
+
+	long _num_hits;
+
+	int add_input(const string& name);
+	int convert(const string& signal, const Model& model, unordered_map<string, const Gate*>& drivers,
+			unordered_map<string, int>& literals);
+
+public:
+	Aig(const Model& model);
+
+	static int negate(int literal);
+	static int node(int literal);
+	static bool is_complement(int literal);
+
+	int make_and(int x, int y);
+	int make_or(int x, int y);
+
+	int num_nodes() const;
+	int num_ands() const;
+	bool is_and(int node) const;
+
+	// Rebuild a model with one two-input gate per AND node reachable from
+	// the outputs and latch inputs
+	Model to_model() const;
+
+	void output_status(ostream& out) const;
+};
+
+inline int Aig::negate(int literal)
+{
+	return literal ^ 1;
+}
+
+inline int Aig::node(int literal)
+{
+	return literal >> 1;
+}
+
+inline bool Aig::is_complement(int literal)
+{
+	return literal & 1;
+}
+
+inline int Aig::make_or(int x, int y)
+{
+	return negate(make_and(negate(x), negate(y)));
+}
+
+inline int Aig::num_nodes() const
+{
+	return _fanin0.size();
+}
+
+inline int Aig::num_ands() const
+{
+	return num_nodes() - 1 - _inputs.size();
+}
+
+inline bool Aig::is_and(int node) const
+{
+	return node > static_cast<int>(_inputs.size());
+}
+
+#endif
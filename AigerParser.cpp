@@ -0,0 +1,325 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "AigerParser.h"
+
+static const char* FALSE_NAME = "aiger$false";
+// AND nodes are named by index under a prefix no symbol table uses
+static const string AND_PREFIX = "aiger$n";
+
+AigerParser::AigerParser()
+	: in(nullptr), _num_vars(0), _num_inputs(0), _num_latches(0), _num_outputs(0), _num_ands(0), _num_bad(0),
+	  _uses_false(false)
+{
+}
+
+bool AigerParser::is_aiger(const char* file)
+{
+	// Standard input cannot be read twice
+	if (strcmp(file, "-") == 0) {
+		return false;
+	}
+
+	InputFile input;
+	if (!input.open(file)) {
+		return false;
+	}
+	char magic[4] = {};
+	streambuf* buffer = input.buffer();
+	for (int i = 0; i < 4; i++) {
+		int c = buffer->sbumpc();
+		if (c == char_traits<char>::eof()) {
+			break;
+		}
+		magic[i] = c;
+	}
+	input.close();
+	return (strncmp(magic, "aig ", 4) == 0 || strncmp(magic, "aag ", 4) == 0);
+}
+
+bool AigerParser::fail(const string& message)
+{
+	cout << message << endl;
+	in.rdbuf(nullptr);
+	_input.close();
+	return false;
+}
+
+bool AigerParser::parse(const char* file)
+{
+	if (!_input.open(file)) {
+		cout << "Cannot find the file: " << file << endl;
+		return false;
+	}
+	in.rdbuf(_input.buffer());
+	in.clear();
+
+	string line;
+	getline(in, line);
+	istringstream header(line);
+	string format;
+	header >> format >> _num_vars >> _num_inputs >> _num_latches >> _num_outputs >> _num_ands;
+	if (!header || (format != "aig" && format != "aag")) {
+		return fail("Invalid AIGER header: " + line);
+	}
+	bool binary = format == "aig";
+	// AIGER 1.9: bad states, invariant constraints, justice and fairness properties
+	unsigned num_constraints = 0;
+	unsigned num_justice = 0;
+	unsigned num_fairness = 0;
+	header >> _num_bad >> num_constraints >> num_justice >> num_fairness;
+	if (num_justice > 0 || num_fairness > 0) {
+		cout << "Ignoring " << num_justice << " justice and " << num_fairness << " fairness properties" << endl;
+	}
+
+	vector<unsigned> input_literals;
+	for (unsigned i = 0; i < _num_inputs; i++) {
+		input_literals.push_back(binary ? 2 * (i + 1) : read_number());
+	}
+	vector<unsigned> latch_literals;
+	vector<unsigned> next_literals;
+	vector<unsigned> init_literals;
+	for (unsigned i = 0; i < _num_latches; i++) {
+		// The latch (ASCII only), the next state and, optionally, the initial value
+		getline(in, line);
+		istringstream tokens(line);
+		unsigned latch = 2 * (_num_inputs + i + 1);
+		unsigned next;
+		unsigned init = 0;
+		if (!binary) {
+			tokens >> latch;
+		}
+		tokens >> next;
+		if (!tokens) {
+			return fail("Invalid AIGER latch: " + line);
+		}
+		tokens >> init;
+		latch_literals.push_back(latch);
+		next_literals.push_back(next);
+		init_literals.push_back(init);
+	}
+	vector<unsigned> output_literals;
+	for (unsigned i = 0; i < _num_outputs + _num_bad; i++) {
+		output_literals.push_back(read_number());
+	}
+	if (!in) {
+		return fail("Invalid AIGER file");
+	}
+	for (unsigned i = 0; i < num_constraints + num_justice + num_fairness; i++) {
+		getline(in, line);
+	}
+	if (num_justice > 0) {
+		// Justice properties list their sizes first, then the literals
+		return fail("Justice properties are not supported");
+	}
+
+	vector<unsigned> and_literals(_num_ands);
+	vector<unsigned> rhs0(_num_ands);
+	vector<unsigned> rhs1(_num_ands);
+	for (unsigned i = 0; i < _num_ands; i++) {
+		if (binary) {
+			and_literals[i] = 2 * (_num_inputs + _num_latches + i + 1);
+			rhs0[i] = and_literals[i] - read_delta();
+			rhs1[i] = rhs0[i] - read_delta();
+		}
+		else {
+			getline(in, line);
+			istringstream tokens(line);
+			tokens >> and_literals[i] >> rhs0[i] >> rhs1[i];
+			if (!tokens) {
+				return fail("Invalid AIGER AND: " + line);
+			}
+		}
+	}
+	if (!in) {
+		return fail("Invalid AIGER file");
+	}
+
+	vector<string> input_names(_num_inputs);
+	vector<string> latch_names(_num_latches);
+	vector<string> output_names(_num_outputs + _num_bad);
+	read_symbols(input_names, latch_names, output_names);
+
+	in.rdbuf(nullptr);
+	if (!_input.close()) {
+		cout << "Cannot decompress the file: " << file << endl;
+		return false;
+	}
+
+	// Every literal must name a variable of the header
+	unsigned max_literal = 2 * _num_vars + 1;
+	for (const auto* literals : {&input_literals, &latch_literals, &next_literals, &output_literals, &and_literals, &rhs0, &rhs1}) {
+		for (const auto& literal : *literals) {
+			if (literal > max_literal) {
+				cout << "Invalid AIGER literal: " << literal << endl;
+				return false;
+			}
+		}
+	}
+
+	// Name every variable: inputs and latches by symbol, AND nodes by index
+	_names.assign(_num_vars + 1, "");
+	_uses_false = false;
+	for (unsigned i = 0; i < _num_inputs; i++) {
+		_names[input_literals[i] / 2] = input_names[i].empty() ? "i" + to_string(i) : input_names[i];
+	}
+	for (unsigned i = 0; i < _num_latches; i++) {
+		_names[latch_literals[i] / 2] = latch_names[i].empty() ? "l" + to_string(i) : latch_names[i];
+	}
+	vector<bool> renamable(_num_vars + 1, false);
+	for (unsigned i = 0; i < _num_ands; i++) {
+		_names[and_literals[i] / 2] = AND_PREFIX + to_string(and_literals[i] / 2);
+		renamable[and_literals[i] / 2] = true;
+	}
+
+	vector<string> outputs(_num_outputs + _num_bad);
+	for (unsigned i = 0; i < outputs.size(); i++) {
+		outputs[i] = output_names[i];
+		if (outputs[i].empty()) {
+			outputs[i] = i < _num_outputs ? "o" + to_string(i) : "b" + to_string(i - _num_outputs);
+		}
+		// The first output driven by a positive AND node names that node directly
+		unsigned var = output_literals[i] / 2;
+		if (renamable[var] && !(output_literals[i] & 1)) {
+			_names[var] = outputs[i];
+			renamable[var] = false;
+		}
+	}
+
+	_models.push_back(Model());
+	Model& model = _models.back();
+	model.create_arena();
+	const char* base = strrchr(file, '/');
+	model.name() = base == nullptr ? file : base + 1;
+	for (unsigned i = 0; i < _num_inputs; i++) {
+		model.inputs().push_back(_names[input_literals[i] / 2]);
+	}
+
+	for (unsigned i = 0; i < _num_ands; i++) {
+		Gate& gate = model.add_gate();
+		gate.name() = _names[and_literals[i] / 2];
+		gate.output() = gate.name();
+		gate.inputs().push_back(literal_name(rhs0[i] & ~1u));
+		if ((rhs1[i] >> 1) != (rhs0[i] >> 1)) {
+			gate.inputs().push_back(literal_name(rhs1[i] & ~1u));
+		}
+		Gate::Signals& row = gate.add_row();
+		row.push_back(literal_name(rhs0[i]));
+		row.push_back(literal_name(rhs1[i]));
+	}
+
+	for (unsigned i = 0; i < outputs.size(); i++) {
+		if (output_literals[i] & 1 || output_literals[i] < 2 || _names[output_literals[i] / 2] != outputs[i]) {
+			add_buffer(model, output_literals[i], outputs[i]);
+		}
+		model.outputs().push_back(outputs[i]);
+	}
+
+	for (unsigned i = 0; i < _num_latches; i++) {
+		Latch& latch = model.add_latch();
+		latch.output() = _names[latch_literals[i] / 2];
+		if (next_literals[i] >= 2 && !(next_literals[i] & 1)) {
+			latch.input() = _names[next_literals[i] / 2];
+		}
+		else {
+			latch.input() = latch.output() + "$next";
+			add_buffer(model, next_literals[i], latch.input());
+		}
+		// An initial value equal to the latch itself leaves it uninitialized; it starts at 0
+		latch.init_value() = init_literals[i] == 1;
+	}
+
+	if (_uses_false) {
+		Gate& gate = model.add_gate();
+		gate.name() = FALSE_NAME;
+		gate.output() = FALSE_NAME;
+		gate.constant() = false;
+	}
+	return true;
+}
+
+unsigned AigerParser::read_number()
+{
+	// A failure is left in the stream for the caller to check
+	unsigned number = 0;
+	in >> number;
+	if (!in) {
+		return 0;
+	}
+	// One number per line; the binary AND section starts after the last one
+	in.ignore(numeric_limits<streamsize>::max(), '\n');
+	return number;
+}
+
+unsigned AigerParser::read_delta()
+{
+	unsigned delta = 0;
+	for (int shift = 0; ; shift += 7) {
+		int c = in.get();
+		if (c == char_traits<char>::eof()) {
+			in.setstate(ios::failbit);
+			return 0;
+		}
+		delta |= static_cast<unsigned>(c & 0x7f) << shift;
+		if (!(c & 0x80)) {
+			return delta;
+		}
+	}
+}
+
+void AigerParser::read_symbols(vector<string>& input_names, vector<string>& latch_names, vector<string>& output_names)
+{
+	string line;
+	while (getline(in, line)) {
+		if (line.empty() || line[0] == 'c') {
+			// The comment section ends the file
+			break;
+		}
+		size_t space = line.find(' ');
+		if (space == string::npos) {
+			continue;
+		}
+		unsigned position = strtoul(line.c_str() + 1, nullptr, 10);
+		string name = line.substr(space + 1);
+		if (line[0] == 'i' && position < input_names.size()) {
+			input_names[position] = name;
+		}
+		else if (line[0] == 'l' && position < latch_names.size()) {
+			latch_names[position] = name;
+		}
+		else if (line[0] == 'o' && position < _num_outputs) {
+			output_names[position] = name;
+		}
+		else if (line[0] == 'b' && position < _num_bad) {
+			output_names[_num_outputs + position] = name;
+		}
+	}
+}
+
+string AigerParser::literal_name(unsigned literal)
+{
+	if (literal < 2) {
+		// Constant true is the complement of the constant false gate
+		_uses_false = true;
+		return literal == 1 ? string("-") + FALSE_NAME : string(FALSE_NAME);
+	}
+	const string& name = _names[literal / 2];
+	return (literal & 1) ? "-" + name : name;
+}
+
+void AigerParser::add_buffer(Model& model, unsigned literal, const string& name)
+{
+	Gate& gate = model.add_gate();
+	gate.name() = name;
+	gate.output() = name;
+	if (literal < 2) {
+		gate.constant() = literal == 1;
+	}
+	else {
+		gate.inputs().push_back(_names[literal / 2]);
+		gate.add_row().push_back(literal_name(literal));
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef AIGERPARSER_H_
+#define AIGERPARSER_H_
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+#include "InputFile.h"
+
+using namespace std;
+
+// Reader of AIGER files, binary (aig) or ASCII (aag), into a single model.
+// AND nodes become two-input gates with one cube; bad state properties are read as outputs.
+class AigerParser
+{
+private:
+	InputFile _input;
+	istream in;
+
+	unsigned _num_vars;
+	unsigned _num_inputs;
+	unsigned _num_latches;
+	unsigned _num_outputs;
+	unsigned _num_ands;
+	unsigned _num_bad;
+
+	// Signal name of every variable
+	vector<string> _names;
+	bool _uses_false;
+	vector<Model> _models;
+
+	// Both leave the stream failed on malformed input
+	unsigned read_number();
+	unsigned read_delta();
+	void read_symbols(vector<string>& input_names, vector<string>& latch_names, vector<string>& output_names);
+
+	// Report the error, release the input and return false
+	bool fail(const string& message);
+
+	string literal_name(unsigned literal);
+	// Gate driving the named signal with the literal
+	void add_buffer(Model& model, unsigned literal, const string& name);
+
+public:
+	AigerParser();
+
+	// Whether the file starts like an AIGER file
+	static bool is_aiger(const char* file);
+
+	// False if the file cannot be read or is not valid AIGER
+	bool parse(const char* file);
+	const vector<Model>& models() const;
+	vector<Model> release_models();
+};
+
+inline const vector<Model>& AigerParser::models() const
+{
+	return _models;
+}
+
+inline vector<Model> AigerParser::release_models()
+{
+	return std::move(_models);
+}
+
+#endif
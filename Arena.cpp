@@ -0,0 +1,33 @@
+#include <algorithm>
+
+#include "Arena.h"
+
+const size_t Arena::CHUNK_SIZE;
+
+Arena::Arena()
+	: _next(nullptr), _end(nullptr), _num_bytes(0)
+{
+}
+
+Arena::~Arena()
+{
+	for (auto& chunk : _chunks) {
+		delete[] chunk;
+	}
+}
+
+void* Arena::allocate_chunk(size_t size, size_t alignment)
+{
+	size_t chunk_size = std::max(CHUNK_SIZE, size + alignment);
+	char* chunk = new char[chunk_size];
+	_chunks.push_back(chunk);
+
+	uintptr_t address = (reinterpret_cast<uintptr_t>(chunk) + alignment - 1) & ~(alignment - 1);
+	_num_bytes += size;
+	// Large blocks get a chunk of their own; the current chunk stays in use
+	if (size < CHUNK_SIZE / 2) {
+		_next = reinterpret_cast<char*>(address + size);
+		_end = chunk + chunk_size;
+	}
+	return reinterpret_cast<void*>(address);
+}
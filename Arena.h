@@ -0,0 +1,111 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+// Bump allocator: memory is handed out from large chunks and only released,
+// all at once, when the arena is destroyed
+class Arena
+{
+private:
+	static const size_t CHUNK_SIZE = 64 * 1024;
+
+	vector<char*> _chunks;
+	char* _next;
+	char* _end;
+	size_t _num_bytes;
+
+	void* allocate_chunk(size_t size, size_t alignment);
+
+public:
+	Arena();
+	~Arena();
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* allocate(size_t size, size_t alignment);
+
+	size_t num_bytes() const;
+	size_t num_chunks() const;
+};
+
+inline void* Arena::allocate(size_t size, size_t alignment)
+{
+	uintptr_t address = (reinterpret_cast<uintptr_t>(_next) + alignment - 1) & ~(alignment - 1);
+	if (_next == nullptr || address + size > reinterpret_cast<uintptr_t>(_end)) {
+		return allocate_chunk(size, alignment);
+	}
+	_next = reinterpret_cast<char*>(address + size);
+	_num_bytes += size;
+	return reinterpret_cast<void*>(address);
+}
+
+inline size_t Arena::num_bytes() const
+{
+	return _num_bytes;
+}
+
+inline size_t Arena::num_chunks() const
+{
+	return _chunks.size();
+}
+
+// Standard allocator drawing from a shared arena, or from the heap if there is none.
+// Containers keep the arena alive, so they may outlive the model that created it.
+template <typename T>
+class ArenaAllocator
+{
+private:
+	shared_ptr<Arena> _arena;
+
+public:
+	typedef T value_type;
+
+	ArenaAllocator() {}
+	ArenaAllocator(const shared_ptr<Arena>& arena) : _arena(arena) {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena()) {}
+
+	T* allocate(size_t n);
+	void deallocate(T* p, size_t n);
+
+	const shared_ptr<Arena>& arena() const { return _arena; }
+};
+
+template <typename T>
+inline T* ArenaAllocator<T>::allocate(size_t n)
+{
+	if (!_arena) {
+		return static_cast<T*>(::operator new(n * sizeof(T)));
+	}
+	return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+}
+
+template <typename T>
+inline void ArenaAllocator<T>::deallocate(T* p, size_t)
+{
+	// Arena memory is released with the arena
+	if (!_arena) {
+		::operator delete(p);
+	}
+}
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& x, const ArenaAllocator<U>& y)
+{
+	return x.arena() == y.arena();
+}
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& x, const ArenaAllocator<U>& y)
+{
+	return x.arena() != y.arena();
+}
+
+#endif
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <iostream>
 #include <boost/algorithm/string.hpp>
 
@@ -5,46 +6,223 @@
 
 using namespace std;
 
-void BlifParser::parse(const char* file)
+BlifParser::BlifParser(bool use_arena)
+	: in(nullptr), _use_arena(use_arena)
 {
-	in.open(file);
-	if (!in.is_open()) {
+}
+
+bool BlifParser::parse(const char* file)
+{
+	if (!open(file)) {
+		return false;
+	}
+	read_next_line_and_skip_comment();
+	parse_all();
+	return close(file);
+}
+
+bool BlifParser::parse(const char* file, const vector<string>& names)
+{
+	if (!open(file)) {
+		return false;
+	}
+	if (_input.is_seekable()) {
+		build_index();
+		for (const auto& name : names) {
+			if (!load(name)) {
+				close(file);
+				return false;
+			}
+		}
+	}
+	else {
+		cout << "Parsing every model: the input cannot seek" << endl;
+		read_next_line_and_skip_comment();
+		parse_all();
+
+		vector<size_t> order;
+		for (const auto& name : names) {
+			if (!collect(name, order)) {
+				close(file);
+				return false;
+			}
+		}
+		unordered_map<string, size_t> positions;
+		for (size_t i = 0; i < _models.size(); i++) {
+			positions.emplace(_models[i].name(), i);
+		}
+		vector<Model> selected;
+		for (const auto& entry : order) {
+			selected.push_back(std::move(_models[positions[_index[entry].name]]));
+		}
+		_models.swap(selected);
+	}
+	return close(file);
+}
+
+bool BlifParser::index(const char* file)
+{
+	if (!open(file)) {
+		return false;
+	}
+	if (!_input.is_seekable()) {
+		close(file);
+		return false;
+	}
+	build_index();
+	return true;
+}
+
+bool BlifParser::load(const string& name)
+{
+	vector<size_t> order;
+	if (!collect(name, order)) {
+		return false;
+	}
+	for (const auto& entry : order) {
+		in.clear();
+		in.seekg(_index[entry].offset);
+		read_next_line_and_skip_comment();
+		_models.push_back(Model());
+		Model& model = _models.back();
+		if (_use_arena) {
+			model.create_arena();
+		}
+		parse_model(model);
+	}
+	return true;
+}
+
+bool BlifParser::open(const char* file)
+{
+	if (!_input.open(file)) {
 		cout << "Cannot find the file: " << file << endl;
-		exit(1);
+		return false;
 	}
+	in.rdbuf(_input.buffer());
+	in.clear();
+	if (strcmp(_input.compression(), "none") != 0) {
+		cout << "Decompressing " << file << " with " << _input.compression() << endl;
+	}
+	return true;
+}
 
-	read_next_line_and_skip_comment();
+bool BlifParser::close(const char* file)
+{
+	in.rdbuf(nullptr);
+	if (!_input.close()) {
+		cout << "Cannot decompress the file: " << file << endl;
+		return false;
+	}
+	return true;
+}
+
+void BlifParser::parse_all()
+{
 	while(!in.eof()){
 		_models.push_back(Model());
 		Model& model = _models.back();
+		if (_use_arena) {
+			model.create_arena();
+		}
 		parse_model(model);
 	}
 }
 
+void BlifParser::build_index()
+{
+	static const char* SPACES = " \t\r";
+
+	string text;
+	size_t entry = _index.size();
+	while (true) {
+		// Nothing is parsed, but lines are still read one at a time to find their offsets
+		streamoff offset = in.tellg();
+		if (!getline(in, text)) {
+			break;
+		}
+		size_t begin = text.find_first_not_of(SPACES);
+		if (begin == string::npos || text[begin] != '.') {
+			continue;
+		}
+		if (text.compare(begin, 7, ".model ") == 0 || text.compare(begin, 7, ".model\t") == 0) {
+			line = text;
+			tokenize();
+			entry = add_entry(_tokens[1], offset);
+		}
+		else if (text.compare(begin, 8, ".subckt ") == 0 && entry < _index.size()) {
+			line = text;
+			tokenize();
+			_index[entry].subckts.push_back(_tokens[1]);
+		}
+	}
+	cout << "Indexed " << _index.size() << " models" << endl;
+}
+
+size_t BlifParser::add_entry(const string& name, streamoff offset)
+{
+	const auto itr = _entries.find(name);
+	if (itr != _entries.end()) {
+		cout << "Duplicate model: " << name << endl;
+		return itr->second;
+	}
+	_entries.emplace(name, _index.size());
+	_index.push_back(ModelEntry());
+	ModelEntry& entry = _index.back();
+	entry.name = name;
+	entry.offset = offset;
+	entry.loaded = false;
+	return _index.size() - 1;
+}
+
+bool BlifParser::collect(const string& name, vector<size_t>& order)
+{
+	const auto itr = _entries.find(name);
+	if (itr == _entries.end()) {
+		cout << "Model not found: " << name << endl;
+		return false;
+	}
+	size_t entry = itr->second;
+	if (_index[entry].loaded) {
+		return true;
+	}
+	_index[entry].loaded = true;
+
+	for (const auto& subckt : _index[entry].subckts) {
+		if (_entries.find(subckt) == _entries.end()) {
+			cout << "Model not found for .subckt: " << subckt << endl;
+			continue;
+		}
+		collect(subckt, order);
+	}
+	order.push_back(entry);
+	return true;
+}
+
 void BlifParser::parse_model(Model& model)
 {
 	assert(boost::algorithm::starts_with(line, ".model"));
 
-	vector<string> tokens;
-	boost::algorithm::split(tokens, line, boost::is_space(), boost::algorithm::token_compress_on);
-	model.name() = tokens[1];
+	tokenize();
+	model.name() = _tokens[1];
+	// Models read in one pass are indexed as they go
+	size_t entry = _entries.find(model.name()) == _entries.end() ? add_entry(model.name(), -1) : _index.size();
 
 	vector<string> inputs;
 	vector<string> outputs;
-	vector<Gate> gates;
 
 	read_next_line_and_skip_comment();
 	while(!in.eof() && !boost::algorithm::starts_with(line, ".end")){
 		if(boost::algorithm::starts_with(line, ".inputs")){
-			boost::algorithm::split(tokens, line, boost::is_space(), boost::algorithm::token_compress_on);
-			for(vector<string>::iterator itr=tokens.begin()+1; itr!=tokens.end(); itr++){
+			tokenize();
+			for(vector<string>::iterator itr=_tokens.begin()+1; itr!=_tokens.end(); itr++){
 				inputs.push_back(*itr);
 			}
 			read_next_line_and_skip_comment();
 		}
 		else if(boost::algorithm::starts_with(line, ".outputs")){
-			boost::algorithm::split(tokens, line, boost::is_space(), boost::algorithm::token_compress_on);
-			for(vector<string>::iterator itr=tokens.begin()+1; itr!=tokens.end(); itr++){
+			tokenize();
+			for(vector<string>::iterator itr=_tokens.begin()+1; itr!=_tokens.end(); itr++){
 				outputs.push_back(*itr);
 			}
 			read_next_line_and_skip_comment();
@@ -57,6 +235,13 @@ void BlifParser::parse_model(Model& model)
 			Latch& latch = model.add_latch();
 			parse_latch(latch);
 		}
+		else if(boost::algorithm::starts_with(line, ".subckt")){
+			tokenize();
+			if(entry < _index.size()){
+				_index[entry].subckts.push_back(_tokens[1]);
+			}
+			read_next_line_and_skip_comment();
+		}
 		else{
 			read_next_line_and_skip_comment();
 		}
@@ -72,14 +257,12 @@ void BlifParser::parse_gate(Gate& gate)
 {
 	assert(boost::algorithm::starts_with(line, ".names"));
 
-	vector<string> tokens;
-	boost::algorithm::split(tokens, line, boost::is_space(), boost::algorithm::token_compress_on);
+	tokenize();
 
-	vector<string> inputs(tokens.begin()+1, tokens.end()-1);
-	string output(tokens.back());
-	gate.name() = output;
-	gate.inputs() = inputs;
-	gate.output() = output;
+	gate.inputs().assign(_tokens.begin()+1, _tokens.end()-1);
+	const Gate::Signals& inputs = gate.inputs();
+	gate.name() = _tokens.back();
+	gate.output() = _tokens.back();
 
 	read_next_line_and_skip_comment();
 	if(inputs.empty()){
@@ -92,34 +275,34 @@ void BlifParser::parse_gate(Gate& gate)
 		}
 	}
 	else{
-		vector<string> row;
 		bool set = false;
 		while(line[0]=='0' || line[0]=='1' || line[0]=='-'){
-			row.clear();
-
-			boost::algorithm::split(tokens, line, boost::is_space(), boost::algorithm::token_compress_on);
-			assert(tokens[0].size()==inputs.size());
+			tokenize();
+			assert(_tokens[0].size()==inputs.size());
 
 			if(!set) {
-				if(tokens[1] == "-") {
+				if(_tokens[1] == "-") {
 					continue;
 				}
-				else if(tokens[1] == "0") {
+				else if(_tokens[1] == "0") {
 					gate.output() = "-" + gate.output();
 				}
 				set = true;
 			}
 
-			string plane = tokens[0];
+			const string& plane = _tokens[0];
+			Gate::Signals& row = gate.add_row();
 			for(size_t i = 0; i < plane.size(); i++) {
 				if(plane[i] == '1'){
 					row.push_back(inputs[i]);
 				}
 				else if(plane[i] == '0'){
-					row.push_back("-" + inputs[i]);
+					row.emplace_back();
+					row.back().reserve(inputs[i].size() + 1);
+					row.back() += '-';
+					row.back() += inputs[i];
 				}
 			}
-			gate.add_row(row);
 
 			read_next_line_and_skip_comment();
 		}
@@ -130,12 +313,14 @@ void BlifParser::parse_latch(Latch& latch)
 {
 	assert(boost::algorithm::starts_with(line, ".latch"));
 
-	vector<string> tokens;
-	boost::algorithm::split(tokens, line, boost::is_space(), boost::algorithm::token_compress_on);
+	tokenize();
+
+	latch.input() = _tokens[1];
+	latch.output() = _tokens[2];
+	// .latch input output [type control] [init]
+	latch.init_value() = (_tokens.size() == 4 || _tokens.size() == 6) && _tokens.back() == "1";
 
-	latch.input() = tokens[1];
-	latch.output() = tokens[2];
-	latch.init_value() = (tokens[3] == "1");
+	read_next_line_and_skip_comment();
 }
 
 void BlifParser::read_next_line_and_skip_comment()
@@ -163,3 +348,20 @@ bool BlifParser::is_blank_or_comment(string str)
 {
 	return str=="" || boost::algorithm::starts_with(str, "#");
 }
+
+void BlifParser::tokenize()
+{
+	static const char* SPACES = " \t\n\v\f\r";
+
+	size_t num_tokens = 0;
+	size_t begin = line.find_first_not_of(SPACES);
+	while (begin != string::npos) {
+		size_t end = line.find_first_of(SPACES, begin);
+		if (num_tokens == _tokens.size()) {
+			_tokens.emplace_back();
+		}
+		_tokens[num_tokens++].assign(line, begin, end == string::npos ? string::npos : end - begin);
+		begin = end == string::npos ? end : line.find_first_not_of(SPACES, end);
+	}
+	_tokens.resize(num_tokens);
+}
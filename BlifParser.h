@@ -1,32 +1,77 @@
 #ifndef BLIFPARSER_H_
 #define BLIFPARSER_H_
 
-#include <fstream>
+#include <istream>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Model.h"
+#include "InputFile.h"
 
 using namespace std;
 
 class BlifParser
 {
 private:
-	ifstream in;
+	InputFile _input;
+	istream in;
 	string line;
+	// Tokens of the current line; their buffers are reused from line to line
+	vector<string> _tokens;
+	bool _use_arena;
 
 	vector<Model> _models;
 
+	// Where each model starts and the models its .subckt lines instantiate
+	struct ModelEntry
+	{
+		string name;
+		streamoff offset;
+		vector<string> subckts;
+		bool loaded;
+	};
+	vector<ModelEntry> _index;
+	unordered_map<string, size_t> _entries;
+
+	// Both report a missing or undecompressable file and return false
+	bool open(const char* file);
+	bool close(const char* file);
+	void parse_all();
+	void build_index();
+	size_t add_entry(const string& name, streamoff offset);
+	// Mark the named model and the models it instantiates as loaded, appending the
+	// entries not loaded yet to the order, each after its dependencies; false if the model is unknown
+	bool collect(const string& name, vector<size_t>& order);
+
 	void parse_model(Model& model);
 	void parse_gate(Gate& gate);
 	void parse_latch(Latch& latch);
 
 	void read_next_line_and_skip_comment();
+	void tokenize();
 
 	bool is_blank_or_comment(string str);
 
 public:
-	void parse(const char* file);
+	// Models allocate their gates from an arena each unless use_arena is false
+	BlifParser(bool use_arena = true);
+
+	// The file may be compressed with gzip, xz or zstd; "-" reads standard input.
+	// Both parses return false if the file cannot be read or a named model is unknown.
+	bool parse(const char* file);
+	// Parse only the named models and the models they instantiate, in dependency order.
+	// A seekable file is indexed first and only the selected models are read; any other
+	// input is parsed completely and the rest of the models are dropped.
+	bool parse(const char* file, const vector<string>& names);
+	// Record the offset of every model without parsing any; false if the file cannot be read or seek.
+	// The file stays open for load.
+	bool index(const char* file);
+	// Parse a model of the indexed file, after the models it instantiates; false if it is unknown
+	bool load(const string& name);
 	const vector<Model>& models() const;
+	// Hand the parsed models over to the caller, leaving none behind
+	vector<Model> release_models();
 };
 
 inline const vector<Model>& BlifParser::models() const
@@ -34,4 +79,9 @@ inline const vector<Model>& BlifParser::models() const
 	return _models;
 }
 
+inline vector<Model> BlifParser::release_models()
+{
+	return std::move(_models);
+}
+
 #endif
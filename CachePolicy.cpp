@@ -0,0 +1,20 @@
+#include <cstring>
+
+#include "CachePolicy.h"
+
+bool CachePolicy::set_purge(const char* name)
+{
+	if (strcmp(name, "never") == 0) {
+		purge = NEVER;
+	}
+	else if (strcmp(name, "always") == 0) {
+		purge = ALWAYS;
+	}
+	else if (strcmp(name, "growth") == 0) {
+		purge = GROWTH;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
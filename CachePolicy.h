@@ -0,0 +1,34 @@
+#ifndef CACHEPOLICY_H_
+#define CACHEPOLICY_H_
+
+// When the compute tables of a forest are purged during a build
+class CachePolicy
+{
+public:
+	enum Purge
+	{
+		// Never purge during the build
+		NEVER,
+		// Remove all entries after every input and gate
+		ALWAYS,
+		// Remove stale entries whenever the forest has grown by a factor
+		GROWTH
+	};
+
+	// Maximum number of compute table entries, 0 for the MEDDLY default
+	unsigned max_size;
+	Purge purge;
+	double growth;
+	// Remove all entries before dynamic or explicit reordering
+	bool purge_before_reorder;
+
+	CachePolicy();
+	bool set_purge(const char* name);
+};
+
+inline CachePolicy::CachePolicy()
+	: max_size(0), purge(GROWTH), growth(2.0), purge_before_reorder(true)
+{
+}
+
+#endif
@@ -1,36 +1,56 @@
 #ifndef GATE_H_
 #define GATE_H_
 
+#include <iostream>
 #include <string>
 #include <vector>
 
+#include "Arena.h"
+
 using namespace std;
 
 class Gate
 {
+public:
+	// Input and cube storage comes from the arena of the model, if it has one
+	typedef vector<string, ArenaAllocator<string> > Signals;
+	typedef vector<Signals, ArenaAllocator<Signals> > Cover;
+
 private:
 	string _name;
-	vector<string> _inputs;
+	Signals _inputs;
 	string _output;
-	vector<vector<string> > _rows;
+	Cover _rows;
 	bool _constant;
 
 public:
+	explicit Gate(const ArenaAllocator<string>& allocator = ArenaAllocator<string>())
+		: _inputs(allocator), _rows(allocator), _constant(false)
+	{
+	}
+
 	string& name() { return _name; }
-	string name() const { return _name; }
-	vector<string>& inputs() { return _inputs; }
-	const vector<string>& inputs() const { return _inputs; }
+	const string& name() const { return _name; }
+	Signals& inputs() { return _inputs; }
+	const Signals& inputs() const { return _inputs; }
 	string& output() { return _output; }
-	string output() const { return _output; }
+	const string& output() const { return _output; }
 	bool& constant() { return _constant; }
 	bool constant() const { return _constant; }
 	bool is_constant() const { return _inputs.empty(); }
 
 	void add_row(const vector<string>& row)
 	{
-		_rows.push_back(row);
+		_rows.emplace_back(row.begin(), row.end(), _rows.get_allocator());
+	}
+	// Append an empty cube to be filled in place
+	Signals& add_row()
+	{
+		_rows.emplace_back(_rows.get_allocator());
+		return _rows.back();
 	}
-	const vector<vector<string> >& rows() const { return _rows; };
+	Cover& rows() { return _rows; };
+	const Cover& rows() const { return _rows; };
 
 	friend ostream& operator<<(ostream& out, const Gate& gate)
 	{
@@ -41,9 +61,9 @@ public:
 			out << " " << (gate.constant() ? "TRUE" : "FALSE") << endl;
 		}
 		else{
-			const vector<vector<string> > rows = gate.rows();
+			const Gate::Cover& rows = gate.rows();
 			if(rows.size()==1){
-				for(vector<string>::const_iterator itr=rows[0].begin(); itr!=rows[0].end(); itr++){
+				for(Gate::Signals::const_iterator itr=rows[0].begin(); itr!=rows[0].end(); itr++){
 					out << " " << *itr;
 				}
 			}
@@ -57,7 +77,7 @@ public:
 					}
 					else{
 						out << " (";
-						for(vector<string>::const_iterator itr=rows[i].begin(); itr!=rows[i].end(); itr++){
+						for(Gate::Signals::const_iterator itr=rows[i].begin(); itr!=rows[i].end(); itr++){
 							out << " " << *itr;
 						}
 						out << " )";
@@ -0,0 +1,94 @@
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+
+#include "GroupedModelBuilder.h"
+
+GroupedModelBuilder::GroupedModelBuilder(const Model& model, int max_bits, Grouping grouping)
+	: ModelBuilder(model), _max_bits(max_bits), _grouping(grouping)
+{
+	group_inputs();
+}
+
+void GroupedModelBuilder::group_inputs()
+{
+	const vector<string>& inputs = _model.inputs();
+	int num_inputs = inputs.size();
+
+	// Runs of inputs that may share a variable, ordered by their first input
+	vector<vector<int> > runs;
+	if (_grouping == BY_ORDER) {
+		runs.push_back(vector<int>());
+		for (int i = 1; i <= num_inputs; i++) {
+			runs.back().push_back(i);
+		}
+	}
+	else {
+		// Bits of a bus by index, and the run of every bus name
+		map<string, int> buses;
+		vector<vector<pair<long, int> > > bits;
+		for (int i = 1; i <= num_inputs; i++) {
+			const string& name = inputs[i - 1];
+			size_t open = name.rfind('[');
+			bool indexed = open != string::npos && open > 0 && name.back() == ']' && open + 2 < name.size()
+					&& name.find_first_not_of("0123456789", open + 1) == name.size() - 1;
+			if (!indexed) {
+				bits.push_back(vector<pair<long, int> >(1, make_pair(0L, i)));
+				continue;
+			}
+			auto itr = buses.emplace(name.substr(0, open), bits.size()).first;
+			if (itr->second == static_cast<int>(bits.size())) {
+				bits.push_back(vector<pair<long, int> >());
+			}
+			bits[itr->second].push_back(make_pair(atol(name.c_str() + open + 1), i));
+		}
+		for (auto& bus : bits) {
+			std::sort(bus.begin(), bus.end());
+			runs.push_back(vector<int>());
+			for (const auto& bit : bus) {
+				runs.back().push_back(bit.second);
+			}
+		}
+	}
+
+	_groups.assign(1, vector<int>());
+	_input_vars.assign(num_inputs + 1, 0);
+	_input_bits.assign(num_inputs + 1, 0);
+	for (const auto& run : runs) {
+		for (size_t first = 0; first < run.size(); first += _max_bits) {
+			size_t last = std::min(run.size(), first + _max_bits);
+			_groups.push_back(vector<int>(run.begin() + first, run.begin() + last));
+			for (size_t b = first; b < last; b++) {
+				_input_vars[run[b]] = _groups.size() - 1;
+				_input_bits[run[b]] = b - first;
+			}
+		}
+	}
+}
+
+void GroupedModelBuilder::create_vars()
+{
+	ModelBuilder::create_vars();
+
+	cout << "# Levels: " << actual_num_vars() << " (" << num_input_signals() << " input bits, up to "
+			<< _max_bits << " per variable)" << endl;
+}
+
+void GroupedModelBuilder::build_input(int var)
+{
+	cout << "Building Input " << var << endl;
+
+	// Values of the variable with the bit of the input set
+	int domain_var = _input_vars[var];
+	int bound = variable_bound(domain_var);
+	bool* terms = new bool[bound];
+	for (int v = 0; v < bound; v++) {
+		terms[v] = (v >> _input_bits[var]) & 1;
+	}
+
+	MEDDLY::dd_edge bdd(_mdd_forest);
+	_mdd_forest->createEdgeForVar(domain_var, false, terms, bdd);
+	_bdds[var] = bdd;
+
+	delete[] terms;
+}
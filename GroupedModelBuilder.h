@@ -0,0 +1,68 @@
+#ifndef GROUPEDMODELBUILDER_H_
+#define GROUPEDMODELBUILDER_H_
+
+#include <vector>
+#include <meddly.h>
+
+#include "ModelBuilder.h"
+
+// Encodes groups of up to max_bits input bits as one multi-valued variable of 2^k values.
+// Bits of a bus named like a[0], a[1], ... are grouped by index, or consecutive inputs by
+// their position. An input literal is the set of values with its bit set.
+class GroupedModelBuilder : public ModelBuilder
+{
+public:
+	enum Grouping
+	{
+		BY_NAME,
+		BY_ORDER
+	};
+
+protected:
+	int _max_bits;
+	Grouping _grouping;
+	// Input signals of every variable, least significant bit first (entry 0 unused)
+	vector<vector<int> > _groups;
+	// Variable and bit of every input signal
+	vector<int> _input_vars;
+	vector<int> _input_bits;
+
+	void group_inputs();
+
+	virtual int num_input_signals() const;
+	virtual int variable_bound(int var) const;
+	virtual void build_input(int var);
+	virtual void assign_input(int* vlist, int var, bool value) const;
+
+public:
+	GroupedModelBuilder(const Model& model, int max_bits, Grouping grouping);
+
+	virtual int actual_num_vars() const;
+	virtual void create_vars();
+};
+
+inline int GroupedModelBuilder::num_input_signals() const
+{
+	return _model.inputs().size();
+}
+
+inline int GroupedModelBuilder::variable_bound(int var) const
+{
+	// Padding variables stay binary
+	return var < static_cast<int>(_groups.size()) ? (1 << _groups[var].size()) : 2;
+}
+
+inline void GroupedModelBuilder::assign_input(int* vlist, int var, bool value) const
+{
+	// The bits of a variable are assigned one at a time, starting from 0
+	if (value) {
+		vlist[_input_vars[var]] |= 1 << _input_bits[var];
+	}
+}
+
+inline int GroupedModelBuilder::actual_num_vars() const
+{
+	return _groups.size() - 1;
+}
+
+#endif
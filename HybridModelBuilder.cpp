@@ -0,0 +1,84 @@
+#include <vector>
+
+#include "HybridModelBuilder.h"
+#include "System.h"
+
+HybridModelBuilder::HybridModelBuilder(const Model& model)
+	: Rebuilder(model), _swap_rate(1.0), _rebuild_rate(1.0), _num_swap_calls(0), _num_rebuild_calls(0)
+{
+}
+
+long HybridModelBuilder::count_swaps(const int* from, const int* to, int num_vars)
+{
+	// Target level of every variable
+	vector<int> levels(num_vars + 1, 0);
+	for (int i = 1; i <= num_vars; i++) {
+		levels[to[i]] = i;
+	}
+
+	// Inversions of the target levels read along the current order, counted with a Fenwick tree
+	vector<int> tree(num_vars + 1, 0);
+	long inversions = 0;
+	for (int i = 1; i <= num_vars; i++) {
+		int level = levels[from[i]];
+		int smaller = 0;
+		for (int j = level; j > 0; j -= j & -j) {
+			smaller += tree[j];
+		}
+		inversions += (i - 1) - smaller;
+		for (int j = level; j <= num_vars; j += j & -j) {
+			tree[j]++;
+		}
+	}
+	return inversions;
+}
+
+void HybridModelBuilder::calibrate(double& rate, int& num_calls, double work, double time)
+{
+	if (work <= 0) {
+		return;
+	}
+	// The first measurement replaces the initial guess, later ones are averaged in
+	rate = num_calls == 0 ? time / work : 0.5 * rate + 0.5 * time / work;
+	num_calls++;
+}
+
+void HybridModelBuilder::reorder(int* order)
+{
+	int* current = new int[_num_vars + 1];
+	current[0] = 0;
+	get_variable_order(current);
+	long swaps = count_swaps(current, order, _num_vars);
+	delete[] current;
+
+	// An adjacent swap touches the nodes of two levels, a rebuild every node once
+	long nodes = num_nodes();
+	double swap_work = 2.0 * swaps * nodes / _num_vars;
+	double rebuild_work = nodes;
+	// Until a method has been measured, assume the rate of the other one
+	double swap_rate = _num_swap_calls > 0 ? _swap_rate : _rebuild_rate;
+	double rebuild_rate = _num_rebuild_calls > 0 ? _rebuild_rate : swap_rate;
+	double swap_cost = swap_rate * swap_work;
+	double rebuild_cost = rebuild_rate * rebuild_work;
+	bool use_swaps = swap_cost <= rebuild_cost;
+
+	cout << "Hybrid: " << swaps << " swaps, " << nodes << " nodes, estimate "
+			<< swap_cost << " (swap) vs " << rebuild_cost << " (rebuild) -> " << (use_swaps ? "SWAP" : "REBUILD") << endl;
+
+	double start_time = get_cpu_time();
+	if (use_swaps) {
+		ModelBuilder::reorder(order);
+	}
+	else {
+		Rebuilder::reorder(order);
+	}
+	double end_time = get_cpu_time();
+
+	if (use_swaps) {
+		calibrate(_swap_rate, _num_swap_calls, swap_work, end_time - start_time);
+	}
+	else {
+		calibrate(_rebuild_rate, _num_rebuild_calls, rebuild_work, end_time - start_time);
+	}
+	cout << "Time: " << (end_time - start_time) << " s" << endl;
+}
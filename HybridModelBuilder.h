@@ -0,0 +1,26 @@
+#ifndef HYBRIDMODELBUILDER_H_
+#define HYBRIDMODELBUILDER_H_
+
+#include "Rebuilder.h"
+
+// Reorders either in place by adjacent swaps or by rebuilding into a new forest,
+// whichever is estimated to be cheaper for the requested permutation
+class HybridModelBuilder : public Rebuilder
+{
+protected:
+	// Measured seconds per unit of estimated work, refined after every call
+	double _swap_rate;
+	double _rebuild_rate;
+	int _num_swap_calls;
+	int _num_rebuild_calls;
+
+	// Number of adjacent swaps that turn one order into the other
+	static long count_swaps(const int* from, const int* to, int num_vars);
+	static void calibrate(double& rate, int& num_calls, double work, double time);
+
+public:
+	HybridModelBuilder(const Model& model);
+	virtual void reorder(int* order);
+};
+
+#endif
@@ -1,16 +1,24 @@
+#include <cstdio>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <meddly.h>
 #include <meddly_expert.h>
 
 #include "IndexSetModelBuilder.h"
+#include "System.h"
 
 IndexSetModelBuilder::IndexSetModelBuilder(const Model& model)
 	: ModelBuilder(model), _evplus_forest(nullptr)
 {
 }
 
-void IndexSetModelBuilder::construct_index_sets()
+void IndexSetModelBuilder::construct_index_sets(int num_jobs)
 {
 	cout << "Constructing Index Sets of BDDs..." << endl;
+	double start_time = get_wall_time();
 
 	MEDDLY::forest::policies p(false);
 	//p.setQuasiReduced();
@@ -18,30 +26,215 @@ void IndexSetModelBuilder::construct_index_sets()
 	int* order = new int[num_vars() + 1];
 	order[0] = 0;
 	static_cast<MEDDLY::expert_forest*>(_mdd_forest)->getVariableOrder(order);
-
-	for (int i = 0; i < num_vars() + 1; i++) {
-		cout << order[i] << ", ";
-	}
-	cout << endl;
-
 	static_cast<MEDDLY::expert_forest*>(_evplus_forest)->reorderVariables(order);
 	delete[] order;
 
-	MEDDLY::FILE_output out(stdout);
+	vector<string> outputs;
 	for (const auto& bdd : _output_bdds) {
-		cout << bdd.first << " (MDD): " << bdd.second.getNodeCount() << " Card: " << bdd.second.getCardinality() << endl;
-		MEDDLY::dd_edge evplus_bdd(_evplus_forest);
-//		bdd.second.show(out, 2);
-		MEDDLY::apply(MEDDLY::CONVERT_TO_INDEX_SET, bdd.second, evplus_bdd);
-		cout << bdd.first << " (EV+): " << evplus_bdd.getNodeCount() << " Card: " << evplus_bdd.getCardinality() << endl;
-//		evplus_bdd.show(out, 2);
-		_output_evplus_bdds.emplace(bdd.first, evplus_bdd);
+		outputs.push_back(bdd.first);
+	}
+
+	num_jobs = std::max(1, std::min(num_jobs, static_cast<int>(outputs.size())));
+	if (num_jobs == 1) {
+		vector<MEDDLY::dd_edge> evplus_bdds;
+		vector<double> cardinalities;
+		convert(outputs, evplus_bdds, cardinalities);
+		for (size_t i = 0; i < outputs.size(); i++) {
+			store(outputs[i], evplus_bdds[i], cardinalities[i]);
+		}
+	}
+	else {
+		convert_in_workers(outputs, num_jobs);
 	}
 	_output_bdds.clear();
+
+	double end_time = get_wall_time();
+	cout << "Index Sets: " << outputs.size() << " outputs, " << num_jobs << " jobs, "
+			<< (end_time - start_time) << " s" << endl;
+}
+
+void IndexSetModelBuilder::convert(const vector<string>& outputs, vector<MEDDLY::dd_edge>& evplus_bdds,
+		vector<double>& cardinalities)
+{
+	for (const auto& output : outputs) {
+		const MEDDLY::dd_edge& bdd = _output_bdds.find(output)->second;
+		MEDDLY::dd_edge evplus_bdd(_evplus_forest);
+		MEDDLY::apply(MEDDLY::CONVERT_TO_INDEX_SET, bdd, evplus_bdd);
+		evplus_bdds.push_back(evplus_bdd);
+		// Both representations hold the same set of minterms
+		cardinalities.push_back(bdd.getCardinality());
+	}
+}
+
+void IndexSetModelBuilder::convert_in_workers(const vector<string>& outputs, int num_jobs)
+{
+	// Every worker inherits a copy of the forests and converts every num_jobs-th output.
+	// The results come back through a pipe in the native MEDDLY edge format.
+	vector<vector<string> > slices(num_jobs);
+	for (size_t i = 0; i < outputs.size(); i++) {
+		slices[i % num_jobs].push_back(outputs[i]);
+	}
+
+	vector<pid_t> pids;
+	vector<FILE*> pipes;
+	for (int j = 0; j < num_jobs; j++) {
+		int fds[2];
+		if (pipe(fds) != 0) {
+			perror("pipe");
+			exit(1);
+		}
+
+		cout.flush();
+		fflush(stdout);
+		pid_t pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			exit(1);
+		}
+		if (pid == 0) {
+			close(fds[0]);
+			for (auto& in : pipes) {
+				fclose(in);
+			}
+			FILE* out = fdopen(fds[1], "wb");
+
+			vector<MEDDLY::dd_edge> evplus_bdds;
+			vector<double> cardinalities;
+			convert(slices[j], evplus_bdds, cardinalities);
+
+			fwrite(cardinalities.data(), sizeof(double), cardinalities.size(), out);
+			MEDDLY::FILE_output edges(out);
+			_evplus_forest->writeEdges(edges, evplus_bdds.data(), evplus_bdds.size());
+			int status = ferror(out) ? 1 : 0;
+			fclose(out);
+			// Skip the destructors and atexit handlers of the inherited state
+			_exit(status);
+		}
+
+		close(fds[1]);
+		pids.push_back(pid);
+		pipes.push_back(fdopen(fds[0], "rb"));
+	}
+
+	// Workers run concurrently; a worker blocks on a full pipe until its turn to be read
+	for (int j = 0; j < num_jobs; j++) {
+		const vector<string>& slice = slices[j];
+		vector<double> cardinalities(slice.size());
+		if (fread(cardinalities.data(), sizeof(double), slice.size(), pipes[j]) != slice.size()) {
+			cout << "Worker " << j << " failed" << endl;
+			exit(1);
+		}
+		vector<MEDDLY::dd_edge> evplus_bdds(slice.size(), MEDDLY::dd_edge(_evplus_forest));
+		MEDDLY::FILE_input edges(pipes[j]);
+		_evplus_forest->readEdges(edges, evplus_bdds.data(), evplus_bdds.size());
+		fclose(pipes[j]);
+
+		int status;
+		waitpid(pids[j], &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			cout << "Worker " << j << " failed" << endl;
+			exit(1);
+		}
+
+		for (size_t i = 0; i < slice.size(); i++) {
+			store(slice[i], evplus_bdds[i], cardinalities[i]);
+		}
+	}
+}
+
+void IndexSetModelBuilder::store(const string& output, const MEDDLY::dd_edge& evplus_bdd, double cardinality)
+{
+	cout << output << " (EV+): " << evplus_bdd.getNodeCount() << " Card: " << cardinality << endl;
+	_output_evplus_bdds.emplace(output, evplus_bdd);
+	_cardinalities.emplace(output, cardinality);
+}
+
+long IndexSetModelBuilder::rank(const string& output, const int* assignment) const
+{
+	const auto itr = _output_evplus_bdds.find(output);
+	if (itr == _output_evplus_bdds.end()) {
+		return -1;
+	}
+	long index;
+	_evplus_forest->evaluate(itr->second, assignment, index);
+	if (index < 0 || index >= cardinality(output)) {
+		return -1;
+	}
+
+	// Assignments outside the set evaluate to an arbitrary index
+	vector<int> element(_num_vars + 1);
+	if (!unrank(output, index, element.data())) {
+		return -1;
+	}
+	for (int i = 1; i <= _num_vars; i++) {
+		if (element[i] != assignment[i]) {
+			return -1;
+		}
+	}
+	return index;
+}
+
+bool IndexSetModelBuilder::unrank(const string& output, long index, int* assignment) const
+{
+	const auto itr = _output_evplus_bdds.find(output);
+	if (itr == _output_evplus_bdds.end() || index < 0 || index >= cardinality(output)) {
+		return false;
+	}
+	_evplus_forest->getElement(itr->second, index, assignment);
+	return true;
+}
+
+int IndexSetModelBuilder::enumerate(const string& output, long first, int count, int* buffer) const
+{
+	double total = cardinality(output);
+	if (total < 0 || first < 0 || first > total) {
+		return -1;
+	}
+	int num = 0;
+	for (long index = first; num < count && index < total; index++) {
+		unrank(output, index, buffer + num * (_num_vars + 1));
+		num++;
+	}
+	return num;
+}
+
+bool IndexSetModelBuilder::sample(int num_samples)
+{
+	double start_time = get_cpu_time();
+
+	vector<int> assignment(_num_vars + 1);
+	long num_checked = 0;
+	long mismatches = 0;
+	for (const auto& entry : _output_evplus_bdds) {
+		double total = cardinality(entry.first);
+		if (total < 1) {
+			continue;
+		}
+		// Indices beyond the range of long cannot be unranked
+		uniform_int_distribution<long> distribution(0,
+				total > static_cast<double>(numeric_limits<long>::max()) ? numeric_limits<long>::max() : static_cast<long>(total) - 1);
+		for (int i = 0; i < num_samples; i++) {
+			long index = distribution(RANDOM_ENGINE);
+			if (!unrank(entry.first, index, assignment.data()) || rank(entry.first, assignment.data()) != index) {
+				mismatches++;
+			}
+			num_checked++;
+		}
+	}
+
+	double end_time = get_cpu_time();
+	cout << "Sample: " << num_checked << " assignments, " << mismatches << " mismatches" << endl;
+	cout << (end_time - start_time) << " s" << endl;
+	return mismatches == 0;
 }
 
 void IndexSetModelBuilder::get_variable_order(int* order)
 {
+	// Before the conversion the order is that of the MDD forest
+	if (_evplus_forest == nullptr) {
+		ModelBuilder::get_variable_order(order);
+		return;
+	}
 	MEDDLY::expert_forest* f = static_cast<MEDDLY::expert_forest*>(_evplus_forest);
 //	for(int i = 1; i <= _num_vars; i++) {
 //		order[i] = f->getVarByLevel(i);
@@ -52,12 +245,23 @@ void IndexSetModelBuilder::get_variable_order(int* order)
 
 void IndexSetModelBuilder::swap_adjacent_variable(int lev)
 {
+	if (_evplus_forest == nullptr) {
+		ModelBuilder::swap_adjacent_variable(lev);
+		return;
+	}
 	static_cast<MEDDLY::expert_forest*>(_evplus_forest)->swapAdjacentVariables(lev);
 }
 
 void IndexSetModelBuilder::reorder(int* order)
 {
+	if (_evplus_forest == nullptr) {
+		ModelBuilder::reorder(order);
+		return;
+	}
 	MEDDLY::expert_forest* f = static_cast<MEDDLY::expert_forest*>(_evplus_forest);
+	if (_cache_policy.purge_before_reorder) {
+		f->removeAllComputeTableEntries();
+	}
 	f->resetPeakNumNodes();
 //	f->resetPeakMemoryUsed();
 	f->reorderVariables(order);
@@ -67,12 +271,10 @@ void IndexSetModelBuilder::output_status(ostream& out)
 {
 	out << "Model: " << _model.name() << endl;
 	if (_mdd_forest != nullptr) {
-		static_cast<MEDDLY::expert_forest*>(_mdd_forest)->removeAllComputeTableEntries();
 		out << "MDD Peak Node: " << _mdd_forest->getPeakNumNodes() << endl;
 		out << "MDD Total Node: " << _mdd_forest->getCurrentNumNodes() << endl;
 	}
 	if (_evplus_forest != nullptr) {
-		static_cast<MEDDLY::expert_forest*>(_evplus_forest)->removeAllComputeTableEntries();
 		out << "EV+ Peak Node: " << _evplus_forest->getPeakNumNodes() << endl;
 		out << "EV+ Total Node: " << _evplus_forest->getCurrentNumNodes() << endl;
 	}
@@ -83,4 +285,5 @@ void IndexSetModelBuilder::clean_up()
 	ModelBuilder::clean_up();
 	_evplus_forest = nullptr;
 	_output_evplus_bdds.clear();
+	_cardinalities.clear();
 }
@@ -1,6 +1,7 @@
 #ifndef INDEXSETMODELBUILDER_H_
 #define INDEXSETMODELBUILDER_H_
 
+#include <cstdio>
 #include <unordered_map>
 #include <meddly.h>
 
@@ -12,11 +13,33 @@ protected:
 	MEDDLY::forest* _evplus_forest;
 //	vector<MEDDLY::dd_edge> _evplus_bdds;
 	unordered_map<string, MEDDLY::dd_edge> _output_evplus_bdds;
+	// Number of minterms of every output, computed once during the conversion
+	unordered_map<string, double> _cardinalities;
+
+	void convert(const vector<string>& outputs, vector<MEDDLY::dd_edge>& evplus_bdds, vector<double>& cardinalities);
+	void convert_in_workers(const vector<string>& outputs, int num_jobs);
+	void store(const string& output, const MEDDLY::dd_edge& evplus_bdd, double cardinality);
 
 public:
 	IndexSetModelBuilder(const Model& model);
 
-	void construct_index_sets();
+	// Convert the output BDDs to EV+ index sets, in num_jobs worker processes if more than one
+	void construct_index_sets(int num_jobs = 1);
+
+	// Number of satisfying assignments of an output, -1 if it has no index set
+	double cardinality(const string& output) const;
+
+	// Satisfying assignments of an output, indexed by variable (entry 0 unused),
+	// in the order given by its index set. rank returns -1 and unrank false for an
+	// unknown output, an assignment outside the set or an index out of range.
+	long rank(const string& output, const int* assignment) const;
+	bool unrank(const string& output, long index, int* assignment) const;
+	// Write up to count assignments starting at index first, num_vars() + 1 entries each,
+	// and return how many were written; -1 for an unknown output or a first index
+	// beyond the cardinality
+	int enumerate(const string& output, long first, int count, int* buffer) const;
+	// Check rank(unrank(i)) == i on num_samples uniformly drawn indices of every output
+	bool sample(int num_samples);
 
 	virtual void get_variable_order(int* order);
 	virtual void swap_adjacent_variable(int lev);
@@ -27,4 +50,10 @@ public:
 	virtual void clean_up();
 };
 
+inline double IndexSetModelBuilder::cardinality(const string& output) const
+{
+	const auto itr = _cardinalities.find(output);
+	return itr == _cardinalities.end() ? -1 : itr->second;
+}
+
 #endif
@@ -0,0 +1,247 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "InputFile.h"
+
+const size_t FdStreamBuf::BUFFER_SIZE;
+
+FdStreamBuf::FdStreamBuf(int fd, const string& prefix)
+	: _fd(fd), _buffer(std::max(BUFFER_SIZE, prefix.size())), _offset(lseek(fd, 0, SEEK_CUR))
+{
+	std::copy(prefix.begin(), prefix.end(), _buffer.begin());
+	setg(&_buffer[0], &_buffer[0], &_buffer[0] + prefix.size());
+	if (_offset >= 0) {
+		_offset -= prefix.size();
+	}
+}
+
+FdStreamBuf::int_type FdStreamBuf::underflow()
+{
+	if (gptr() < egptr()) {
+		return traits_type::to_int_type(*gptr());
+	}
+
+	if (_offset >= 0) {
+		_offset += egptr() - eback();
+	}
+	ssize_t num;
+	do {
+		num = read(_fd, &_buffer[0], _buffer.size());
+	} while (num < 0 && errno == EINTR);
+	if (num <= 0) {
+		// The offset already covers the consumed bytes, so none may stay in the get area
+		setg(&_buffer[0], &_buffer[0], &_buffer[0]);
+		return traits_type::eof();
+	}
+	setg(&_buffer[0], &_buffer[0], &_buffer[0] + num);
+	return traits_type::to_int_type(*gptr());
+}
+
+FdStreamBuf::pos_type FdStreamBuf::seekoff(off_type off, ios_base::seekdir dir, ios_base::openmode which)
+{
+	if (_offset < 0 || !(which & ios_base::in)) {
+		return pos_type(off_type(-1));
+	}
+
+	off_type current = _offset + (gptr() - eback());
+	if (dir == ios_base::cur) {
+		// Telling the position is the common case and needs no system call
+		return off == 0 ? pos_type(current) : seekpos(pos_type(current + off), which);
+	}
+	if (dir == ios_base::beg) {
+		return seekpos(pos_type(off), which);
+	}
+	off_t end = lseek(_fd, 0, SEEK_END);
+	if (end < 0) {
+		return pos_type(off_type(-1));
+	}
+	// The buffer no longer matches the descriptor position
+	_offset = end;
+	setg(&_buffer[0], &_buffer[0], &_buffer[0]);
+	return seekpos(pos_type(end + off), which);
+}
+
+FdStreamBuf::pos_type FdStreamBuf::seekpos(pos_type pos, ios_base::openmode which)
+{
+	off_type target = pos;
+	if (_offset < 0 || !(which & ios_base::in) || target < 0) {
+		return pos_type(off_type(-1));
+	}
+
+	// Within the buffered bytes, only the get pointer moves
+	if (target >= _offset && target <= _offset + (egptr() - eback())) {
+		setg(eback(), eback() + (target - _offset), egptr());
+		return pos;
+	}
+	if (lseek(_fd, target, SEEK_SET) < 0) {
+		return pos_type(off_type(-1));
+	}
+	_offset = target;
+	setg(&_buffer[0], &_buffer[0], &_buffer[0]);
+	return pos;
+}
+
+InputFile::InputFile()
+	: _fd(-1), _buffer(nullptr), _compression("none")
+{
+}
+
+InputFile::~InputFile()
+{
+	close();
+}
+
+const char* InputFile::detect(const string& magic)
+{
+	if (magic.compare(0, 2, "\x1f\x8b") == 0) {
+		return "gzip";
+	}
+	if (magic.compare(0, 6, string("\xfd" "7zXZ\0", 6)) == 0) {
+		return "xz";
+	}
+	if (magic.compare(0, 4, "\x28\xb5\x2f\xfd") == 0) {
+		return "zstd";
+	}
+	return nullptr;
+}
+
+bool InputFile::open(const char* file)
+{
+	close();
+
+	bool is_stdin = strcmp(file, "-") == 0;
+	int fd = is_stdin ? STDIN_FILENO : ::open(file, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	// Enough bytes to tell the formats apart
+	char magic[6];
+	ssize_t num = 0;
+	while (num < static_cast<ssize_t>(sizeof(magic))) {
+		ssize_t n = read(fd, magic + num, sizeof(magic) - num);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			break;
+		}
+		num += n;
+	}
+	string prefix(magic, num);
+
+	const char* program = detect(prefix);
+	if (program == nullptr) {
+		_fd = fd;
+		_buffer = new FdStreamBuf(_fd, prefix);
+		return true;
+	}
+
+	int input_fd = fd;
+	if (is_stdin) {
+		// The magic bytes cannot be put back into a pipe
+		input_fd = -1;
+		_children.push_back(feed(prefix, input_fd));
+	}
+	else {
+		lseek(fd, 0, SEEK_SET);
+	}
+	_children.push_back(spawn(program, input_fd, _fd));
+	if (input_fd != STDIN_FILENO) {
+		::close(input_fd);
+	}
+
+	_compression = program;
+	_buffer = new FdStreamBuf(_fd);
+	return true;
+}
+
+pid_t InputFile::spawn(const char* program, int input_fd, int& output_fd)
+{
+	int fds[2];
+	if (pipe(fds) != 0) {
+		perror("pipe");
+		exit(1);
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		exit(1);
+	}
+	if (pid == 0) {
+		dup2(input_fd, STDIN_FILENO);
+		dup2(fds[1], STDOUT_FILENO);
+		::close(fds[0]);
+		::close(fds[1]);
+		execlp(program, program, "-dc", static_cast<char*>(nullptr));
+		_exit(127);
+	}
+	::close(fds[1]);
+	output_fd = fds[0];
+	return pid;
+}
+
+pid_t InputFile::feed(const string& prefix, int& output_fd)
+{
+	int fds[2];
+	if (pipe(fds) != 0) {
+		perror("pipe");
+		exit(1);
+	}
+	pid_t pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		exit(1);
+	}
+	if (pid == 0) {
+		::close(fds[0]);
+		vector<char> buffer(prefix.begin(), prefix.end());
+		buffer.resize(std::max(FdStreamBuf::BUFFER_SIZE, prefix.size()));
+		ssize_t num = prefix.size();
+		do {
+			for (ssize_t written = 0; written < num; ) {
+				ssize_t n = write(fds[1], &buffer[written], num - written);
+				if (n < 0 && errno == EINTR) {
+					continue;
+				}
+				if (n <= 0) {
+					_exit(1);
+				}
+				written += n;
+			}
+			do {
+				num = read(STDIN_FILENO, &buffer[0], buffer.size());
+			} while (num < 0 && errno == EINTR);
+		} while (num > 0);
+		_exit(num == 0 ? 0 : 1);
+	}
+	::close(fds[1]);
+	output_fd = fds[0];
+	return pid;
+}
+
+bool InputFile::close()
+{
+	delete _buffer;
+	_buffer = nullptr;
+	if (_fd > STDIN_FILENO) {
+		::close(_fd);
+	}
+	_fd = -1;
+
+	bool success = true;
+	for (auto& pid : _children) {
+		int status;
+		waitpid(pid, &status, 0);
+		success = success && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	}
+	_children.clear();
+	_compression = "none";
+	return success;
+}
@@ -0,0 +1,88 @@
+#ifndef INPUTFILE_H_
+#define INPUTFILE_H_
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+using namespace std;
+
+// Buffered stream over a file descriptor, optionally starting with bytes already read from it.
+// Positioning works when the descriptor is seekable.
+class FdStreamBuf : public streambuf
+{
+private:
+	int _fd;
+	vector<char> _buffer;
+	// File offset of the start of the buffer; negative if the descriptor cannot seek
+	off_t _offset;
+
+protected:
+	virtual int_type underflow();
+	virtual pos_type seekoff(off_type off, ios_base::seekdir dir, ios_base::openmode which = ios_base::in);
+	virtual pos_type seekpos(pos_type pos, ios_base::openmode which = ios_base::in);
+
+public:
+	static const size_t BUFFER_SIZE = 1 << 16;
+
+	FdStreamBuf(int fd, const string& prefix = "");
+
+	bool is_seekable() const;
+};
+
+inline bool FdStreamBuf::is_seekable() const
+{
+	return _offset >= 0;
+}
+
+// Input file or standard input ("-"). Input compressed with gzip, xz or zstd is recognized
+// by its magic bytes and decompressed while it is read by the corresponding program,
+// running in a separate process.
+class InputFile
+{
+private:
+	int _fd;
+	FdStreamBuf* _buffer;
+	const char* _compression;
+	// Decompressor, and the process feeding it from standard input
+	vector<pid_t> _children;
+
+	static const char* detect(const string& magic);
+	pid_t spawn(const char* program, int input_fd, int& output_fd);
+	pid_t feed(const string& prefix, int& output_fd);
+
+public:
+	InputFile();
+	~InputFile();
+	InputFile(const InputFile&) = delete;
+	InputFile& operator=(const InputFile&) = delete;
+
+	bool open(const char* file);
+	// Release the input; false if the decompressor failed
+	bool close();
+
+	streambuf* buffer() const;
+	// Uncompressed regular files can be read at any offset
+	bool is_seekable() const;
+	// none, gzip, xz or zstd
+	const char* compression() const;
+};
+
+inline streambuf* InputFile::buffer() const
+{
+	return _buffer;
+}
+
+inline bool InputFile::is_seekable() const
+{
+	return _buffer != nullptr && _buffer->is_seekable();
+}
+
+inline const char* InputFile::compression() const
+{
+	return _compression;
+}
+
+#endif
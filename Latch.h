@@ -14,9 +14,9 @@ private:
 
 public:
 	string& input() { return _input; }
-	string input() const { return _input; }
+	const string& input() const { return _input; }
 	string& output() { return _output; }
-	string output() const { return _output; }
+	const string& output() const { return _output; }
 	bool& init_value() { return _init_value; }
 	bool init_value() const { return _init_value; }
 };
@@ -1,17 +1,74 @@
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <random>
 #include <algorithm>
+#include <regex>
+#include <unordered_map>
+#include <unordered_set>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "BlifParser.h"
+#include "AigerParser.h"
 #include "ModelBuilder.h"
 #include "IndexSetModelBuilder.h"
+#include "Aig.h"
 #include "Rebuilder.h"
+#include "HybridModelBuilder.h"
+#include "GroupedModelBuilder.h"
+#include "SequentialModelBuilder.h"
+#include "ReorderBenchmark.h"
+#include "Simulator.h"
+#include "Options.h"
 #include "System.h"
 
 using namespace std;
 
 int print_usage() {
-    cerr << "Usage: BlifParser [INSTANCE] [#REORDER] [HEURISTIC]" << endl;
+    cerr << "Usage: BlifParser [INSTANCE] [#REORDER] [HEURISTIC] [OPTIONS]" << endl;
+    cerr << "       BlifParser --batch JOBFILE [--jobs N] [--results FILE] [--log-dir DIR]" << endl;
+    cerr << "INSTANCE is BLIF or AIGER (aig or aag), possibly compressed with gzip, xz or zstd;" << endl;
+    cerr << "- reads BLIF from standard input" << endl;
+    cerr << "Options:" << endl;
+    cerr << "  --check N    Cross-check the outputs with N rounds of "
+    		<< Simulator::NUM_PATTERNS << " simulated patterns" << endl;
+    cerr << "  --equiv N    Share BDDs of signals proven equivalent after N rounds of simulation" << endl;
+    cerr << "  --aig        Build from the structurally hashed and-inverter graph" << endl;
+    cerr << "  --models A,B         Parse only the named models and the models they instantiate" << endl;
+    cerr << "  --outputs A,B        Build only the named outputs and their cone of influence" << endl;
+    cerr << "  --output-regex RE    Build only the outputs matching RE and their cone of influence" << endl;
+    cerr << "  --ct-size N          Maximum number of compute table entries" << endl;
+    cerr << "  --ct-purge MODE      Purge the compute tables never, always (after every gate) or on growth" << endl;
+    cerr << "  --ct-growth F        Forest growth factor above 1 between purges (default 2)" << endl;
+    cerr << "  --ct-keep-on-reorder Keep the compute tables when reordering" << endl;
+    cerr << "  --truth-tables       Build gates of up to " << TruthTable::MAX_INPUTS
+    		<< " inputs by Shannon construction from cached truth tables" << endl;
+    cerr << "  --group-inputs K     Encode up to K (2 to 16) input bits as one variable of 2^K values" << endl;
+    cerr << "  --group-by MODE      Group the bits of buses like a[0], a[1] by name (default) or consecutive inputs by order" << endl;
+    cerr << "  --group-compare      Also build the grouped models on binary variables and compare levels, nodes and time" << endl;
+    cerr << "  --reach M    Compute the reachable states from the latches by BFS, SAT (saturation)" << endl;
+    cerr << "               or BOTH to compare them" << endl;
+    cerr << "  --save FILE  Save the output BDDs and the variable order after the build" << endl;
+    cerr << "  --index-sets Convert the outputs to EV+ index sets after the transformations (not with REBUILD or HYBRID)" << endl;
+    cerr << "  --jobs N     Number of worker processes for the index set conversion or the batch" << endl;
+    cerr << "  --sample N   Check rank and unrank on N random satisfying assignments per output" << endl;
+    cerr << "  --results FILE       Batch results or benchmark trials table, tab separated (default: standard output)" << endl;
+    cerr << "  --log-dir DIR        Write the log of batch job N to DIR/jobN.log (default: discarded)" << endl;
+    cerr << "  --bench-reorder T    Reorder to #REORDER target orders (RANDOM, DFS or FANIN) in place and" << endl;
+    cerr << "                       by rebuilding, and summarize time, peak and final nodes" << endl;
+    cerr << "  --shards K           Run the benchmark trials in K worker processes from a checkpoint" << endl;
+    cerr << "  --seed S             Seed of the benchmark targets (default 0)" << endl;
+    cerr << "  --portfolio H1,H2    Heuristics tried when HEURISTIC is PORTFOLIO, among LI,HI,SD,BU,LC,LM,RAN,LARC (default: LI,HI,SD,BU,LC,LM,LARC)" << endl;
+    cerr << "  --portfolio-steps N  Gates and inputs built by each trial, 0 for all (default: a tenth of the build)" << endl;
+    cerr << "  --portfolio-time S   CPU seconds for each trial (default: unlimited)" << endl;
+    cerr << "  --parse-bench        Compare allocations, memory and time of parsing INSTANCE on the heap and in arenas;" << endl;
+    cerr << "                       allocations are counted in builds made with make bench only" << endl;
+    cerr << "  --alloc-check        Check that nothing between parsing INSTANCE and building copies strings (make bench)" << endl;
+    cerr << "  --order-in FILE      Initial variable order, one line per model of signal names" << endl;
+    cerr << "                       or #N for variable N, from the bottom level up" << endl;
+    cerr << "  --order-out FILE     Write the variable order reached after optimizing, in the same format" << endl;
+    cerr << "  --load       INSTANCE is a checkpoint written by --save; skips parsing and building" << endl;
     return -1;
 }
 
@@ -156,153 +213,421 @@ void gradual_greedy(ModelBuilder& x, ModelBuilder& y)
 	delete[] y_order;
 }
 
-vector<vector<int>> readOrderFile(const char* filename)
+// One order per line, given by signal names or variable numbers (#N) from the bottom level up
+vector<vector<string>> readOrderFile(const char* filename)
 {
-	vector<vector<int>> orders;
+	vector<vector<string>> orders;
 
 	ifstream in(filename);
-	const int MAX_LINE_LENGTH = 100000;
-	char lineBuffer[MAX_LINE_LENGTH];
-	char literalBuffer[10];
-	while (in.getline(lineBuffer, MAX_LINE_LENGTH)) {
-		vector<int> order;
-
-		char* linePtr = lineBuffer;
-		char* literalPtr = literalBuffer;
-		while (*linePtr != '\0'){
-			literalPtr = literalBuffer;
-			while (*linePtr && isspace(*linePtr)) {
-				linePtr++;
-			}
-			while (*linePtr && !isspace(*linePtr)) {
-				*(literalPtr++) = *(linePtr++); // copy variable
-			}
-			*literalPtr = '\0'; // terminate variable
+	if (!in) {
+		cout << "Cannot open " << filename << endl;
+		exit(1);
+	}
 
-			if (strlen(literalBuffer) > 0) {
-				order.push_back(atoi(literalBuffer));
-			}
+	string line;
+	while (getline(in, line)) {
+		istringstream tokens(line);
+		vector<string> order;
+		string token;
+		while (tokens >> token) {
+			order.push_back(token);
+		}
+		if (!order.empty()) {
+			orders.push_back(order);
 		}
-
-		orders.push_back(order);
 	}
 
 	return orders;
 }
 
-int main(int argc, char* argv[]) {
-    if (argc != 4){
-    	return print_usage();
+// BLIF or AIGER netlist, told apart by the header of the file. Only the named BLIF models
+// and the models they instantiate are parsed, unless there are no names. False if the file
+// cannot be read, is malformed or lacks a named model.
+bool parse_models(const char* file, const vector<string>& names, vector<Model>& models)
+{
+    double start = get_cpu_time();
+    const char* format;
+    if (AigerParser::is_aiger(file)) {
+    	if (!names.empty()) {
+    		cout << "An AIGER file holds a single model; --models applies to BLIF" << endl;
+    		return false;
+    	}
+    	AigerParser parser;
+    	if (!parser.parse(file)) {
+    		return false;
+    	}
+    	models = parser.release_models();
+    	format = "AIGER";
     }
+    else {
+    	BlifParser parser;
+    	if (!(names.empty() ? parser.parse(file) : parser.parse(file, names))) {
+    		return false;
+    	}
+    	models = parser.release_models();
+    	format = "BLIF";
+    }
+    cout << "Parse (" << format << "): " << (get_cpu_time() - start) << " s\n" << endl;
+    return true;
+}
 
-    BlifParser parser;
-    parser.parse(argv[1]);
-    int num = atoi(argv[2]);
-    const char* heuristic = argv[3];
-
-    cout << "Instance: " << argv[1] << endl;
-    cout << "Reordering: " << num << endl;
-    cout << "Method: " << heuristic << "\n" << endl;
+// Jobs selecting the same models of an instance share its parsed netlist
+string netlist_key(const Options& options)
+{
+    string key = options.instance;
+    for (const auto& name : options.models) {
+    	key += "\t" + name;
+    }
+    return key;
+}
 
-    const vector<Model>& ms = parser.models();
+// Models of the instance simplified as selected by the options, reusing the parsed netlist if given
+vector<Model> load_models(const Options& options, const vector<Model>* parsed = nullptr)
+{
     vector<Model> models;
-    models.insert(models.end(), ms.begin(), ms.end());
+    if (options.load) {
+    	// The checkpoint replaces the netlist
+    	models.emplace_back();
+    	models.back().name() = options.instance;
+    	return models;
+    }
+    if (parsed != nullptr) {
+    	models = *parsed;
+    }
+    else if (!parse_models(options.instance, options.models, models)) {
+    	exit(1);
+    }
 
-    vector<ModelBuilder*> builders;
-    int max_num_vars = 0;
+    for (auto& model : models) {
+    	int simplified;
+    	int removed;
+    	model.propagate_constants(simplified, removed);
+    	if (simplified > 0 || removed > 0) {
+    		cout << "Model: " << model.name() << endl;
+    		cout << "# Gates Simplified by Constant Propagation: " << simplified << endl;
+    		cout << "# Unreachable Gates Removed: " << removed << "\n" << endl;
+    	}
+    }
 
-    for (const auto& model : models) {
-    	ModelBuilder* builder = (strcmp(heuristic, "REBUILD") == 0
-    			? new Rebuilder(model) : new ModelBuilder(model));
-    	if(max_num_vars < builder->actual_num_vars()) {
-    		max_num_vars = builder->actual_num_vars();
+    if (!options.outputs.empty() || !options.output_regex.empty()) {
+    	for (auto& model : models) {
+    		vector<string> selected;
+    		for (const auto& output : model.outputs()) {
+    			if (std::find(options.outputs.begin(), options.outputs.end(), output) != options.outputs.end()
+    					|| (!options.output_regex.empty() && regex_match(output, options.output_pattern))) {
+    				selected.push_back(output);
+    			}
+    		}
+    		cout << "Model: " << model.name() << endl;
+    		cout << "# Selected Outputs: " << selected.size() << " of " << model.outputs().size() << endl;
+    		model = model.cone_of_influence(selected);
+    		cout << "# Inputs: " << model.inputs().size() << endl;
+    		cout << "# Gates: " << model.gates().size() << endl;
     	}
-    	builders.push_back(builder);
+    	cout << endl;
     }
 
-    MEDDLY::initialize();
+    if (options.aig) {
+    	for (auto& model : models) {
+    		Aig aig(model);
+    		aig.output_status(cout);
+    		model = aig.to_model();
+    	}
+    	cout << endl;
+    }
 
-#if false
+    return models;
+}
 
-    default_random_engine rg;
-    for(auto& builder : builders){
-    	double start = get_cpu_time();
+void initialize_meddly(const Options& options)
+{
+    if (options.cache_policy.max_size > 0) {
+    	MEDDLY::initializer_list* list = MEDDLY::defaultInitializerList(nullptr);
+    	MEDDLY::ct_initializer::setMaxSize(options.cache_policy.max_size);
+    	MEDDLY::initialize(list);
+    }
+    else {
+    	MEDDLY::initialize();
+    }
+}
+
+// Run the reordering trials in worker processes. Every worker starts from a fresh MEDDLY
+// instance loaded from a checkpoint of the built BDDs and runs a contiguous slice of the trials.
+void run_sharded_benchmark(ModelBuilder* builder, const Options& options, vector<ReorderTrial>& trials)
+{
+    char checkpoint[] = "/tmp/BlifParser-XXXXXX";
+    int fd = mkstemp(checkpoint);
+    if (fd < 0) {
+    	perror("mkstemp");
+    	exit(1);
+    }
+    close(fd);
+    if (!builder->save(checkpoint)) {
+    	exit(1);
+    }
 
-    	builder->set_num_vars(max_num_vars);
-    	builder->initialize(heuristic);
+    int num_trials = options.num_reorder;
+    vector<pid_t> pids;
+    vector<int> pipes;
+    for (int k = 0; k < options.shards; k++) {
+    	int fds[2];
+    	if (pipe(fds) != 0) {
+    		perror("pipe");
+    		exit(1);
+    	}
+    	cout.flush();
+    	fflush(stdout);
+    	pid_t pid = fork();
+    	if (pid < 0) {
+    		perror("fork");
+    		exit(1);
+    	}
+    	if (pid == 0) {
+    		close(fds[0]);
+    		if (freopen("/dev/null", "w", stdout) == nullptr) {
+    			_exit(1);
+    		}
 
-    	builder->build_model();
-//    	builder->output_status(cout);
-    	cout << endl;
+    		// Drop the inherited forests and compute tables
+    		builder->clean_up();
+    		MEDDLY::cleanup();
+    		initialize_meddly(options);
+    		if (!builder->load(checkpoint, options.heuristic)) {
+    			_exit(1);
+    		}
 
-    	builder->optimize();
+    		ReorderBenchmark benchmark(*static_cast<Rebuilder*>(builder), options.seed, options.bench_target);
+    		vector<ReorderTrial> slice;
+    		benchmark.run(k * num_trials / options.shards, (k + 1) * num_trials / options.shards, slice);
+
+    		int num = slice.size();
+    		FILE* out = fdopen(fds[1], "wb");
+    		fwrite(&num, sizeof(num), 1, out);
+    		fwrite(slice.data(), sizeof(ReorderTrial), num, out);
+    		int status = ferror(out) ? 1 : 0;
+    		fclose(out);
+    		_exit(status);
+    	}
+    	close(fds[1]);
+    	pids.push_back(pid);
+    	pipes.push_back(fds[0]);
+    }
 
-//    	builder->construct_index_sets();
+    // Shards are read in order, so the trials stay sorted
+    for (int k = 0; k < options.shards; k++) {
+    	FILE* in = fdopen(pipes[k], "rb");
+    	int num = 0;
+    	bool valid = fread(&num, sizeof(num), 1, in) == 1;
+    	if (valid) {
+    		size_t offset = trials.size();
+    		trials.resize(offset + num);
+    		valid = fread(&trials[offset], sizeof(ReorderTrial), num, in) == static_cast<size_t>(num);
+    	}
+    	fclose(in);
+
+    	int status;
+    	waitpid(pids[k], &status, 0);
+    	if (!valid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    		cout << "Shard " << k << " failed" << endl;
+    		unlink(checkpoint);
+    		exit(1);
+    	}
+    }
+    unlink(checkpoint);
+}
 
-    	builder->output_status(cout);
+// Statistics of one run, summed over its models
+struct RunResult
+{
+	int num_models;
+	int num_vars;
+	long peak_nodes;
+	long num_nodes;
+	double build_time;
+	double total_time;
+};
+
+// Build the model of a grouped builder again on binary variables with the same heuristic, and
+// print both encodings side by side
+void compare_with_binary(const ModelBuilder& grouped, double grouped_time, const Options& options)
+{
+    cout << "Building on Binary Variables..." << endl;
+    ModelBuilder binary(grouped.model());
+    binary.set_cache_policy(options.cache_policy);
+    binary.set_truth_tables(options.truth_tables);
+    binary.set_num_vars(binary.actual_num_vars());
+    double start = get_cpu_time();
+    binary.initialize(options.heuristic);
+    binary.build_model();
+    binary.optimize();
+    double binary_time = get_cpu_time() - start;
+
+    cout << "\nEncoding\tLevels\tPeakNodes\tNodes\tBuild(s)" << endl;
+    cout << "Binary\t" << binary.actual_num_vars() << "\t" << binary.peak_num_nodes() << "\t" << binary.num_nodes()
+    		<< "\t" << binary_time << endl;
+    cout << "Grouped\t" << grouped.actual_num_vars() << "\t" << grouped.peak_num_nodes() << "\t" << grouped.num_nodes()
+    		<< "\t" << grouped_time << "\n" << endl;
+    binary.clean_up();
+}
+
+int run(const Options& options, const vector<Model>& models, RunResult& result)
+{
+    double run_start = get_cpu_time();
+    result = RunResult();
+    result.num_models = models.size();
 
-    	double end = get_cpu_time();
-    	cout << "Time: " << (end - start) << " s" << endl;
+    int num = options.num_reorder;
+    const char* heuristic = options.heuristic;
 
-    	int* order = new int[builder->num_vars() + 1];
-    	order[0] = 0;
-    	builder->get_variable_order(order);
+    cout << "Instance: " << options.instance << endl;
+    cout << "Reordering: " << num << endl;
+    cout << "Method: " << heuristic << "\n" << endl;
 
-    	int* original_order = new int[builder->num_vars() + 1];
-    	original_order[0] = 0;
-    	builder->get_variable_order(original_order);
+    vector<ModelBuilder*> builders;
+    int max_num_vars = 0;
 
-    	cout << "Order: ";
-    	for (int i = 1; i <= builder->num_vars(); i++) {
-    		cout << original_order[i] << ", ";
+    for (const auto& model : models) {
+    	ModelBuilder* builder;
+    	if (options.reach != nullptr) {
+    		builder = new SequentialModelBuilder(model);
+    	}
+    	else if (options.bench_target != nullptr) {
+    		builder = strcmp(heuristic, "HYBRID") == 0 ? new HybridModelBuilder(model) : new Rebuilder(model);
+    	}
+    	else if (options.index_sets) {
+    		builder = new IndexSetModelBuilder(model);
     	}
-    	cout << "\n" << endl;
+    	else if (options.group_bits > 0) {
+    		builder = new GroupedModelBuilder(model, options.group_bits,
+    				options.group_by_order ? GroupedModelBuilder::BY_ORDER : GroupedModelBuilder::BY_NAME);
+    	}
+    	else if (strcmp(heuristic, "REBUILD") == 0) {
+    		builder = new Rebuilder(model);
+    	}
+    	else if (strcmp(heuristic, "HYBRID") == 0) {
+    		builder = new HybridModelBuilder(model);
+    	}
+    	else {
+    		builder = new ModelBuilder(model);
+    	}
+    	builder->set_cache_policy(options.cache_policy);
+    	builder->set_truth_tables(options.truth_tables);
+    	if(max_num_vars < builder->actual_num_vars()) {
+    		max_num_vars = builder->actual_num_vars();
+    	}
+    	builders.push_back(builder);
+    }
 
-    	for (int i = 0; i < num; i++) {
-    		cout << "Reordering..." << endl;
-    		std::shuffle(&order[1], &order[builder->num_vars() + 1], rg);
-//    		builder->dfs_order(order);
+    initialize_meddly(options);
 
-    		cout << "Order: ";
-    		for (int i = 1; i <= builder->num_vars(); i++) {
-    			cout << order[i] << ", ";
+    vector<vector<string>> orders;
+    if (options.order_in != nullptr) {
+    	orders = readOrderFile(options.order_in);
+    }
+    ofstream order_out;
+    if (options.order_out != nullptr) {
+    	order_out.open(options.order_out);
+    }
+
+    cout << "Start transforming..." << endl;
+    for (size_t b = 0; b < builders.size(); b++) {
+    	ModelBuilder* builder = builders[b];
+    	double build_start = get_cpu_time();
+    	if (options.load) {
+    		if (!builder->load(options.instance, heuristic)) {
+    			exit(1);
     		}
     		cout << endl;
+    		if (b < orders.size() && !builder->set_variable_order(orders[b])) {
+    			exit(1);
+    		}
+    	}
+    	else {
+			builder->set_num_vars(max_num_vars);
+			if (strcmp(heuristic, "PORTFOLIO") == 0) {
+				string selected = builder->select_heuristic(options.portfolio, b < orders.size() ? orders[b] : vector<string>(),
+						options.portfolio_steps, options.portfolio_time);
+				if (selected.empty()) {
+					exit(1);
+				}
+				builder->initialize(selected.c_str());
+			}
+			else {
+				builder->initialize(heuristic);
+			}
+			if (b < orders.size() && !builder->set_variable_order(orders[b])) {
+				exit(1);
+			}
 
-    		builder->output_status(cout);
-    		start = get_cpu_time();
-    		builder->reorder(order);
-    		end = get_cpu_time();
-    		builder->output_status(cout);
-    		cout << "Time: " << (end - start) << " s" << endl << endl;
+			if (options.equiv_rounds > 0) {
+				builder->find_equivalences(options.equiv_rounds);
+			}
+
+			builder->build_model();
+//			builder->output_status(cout);
+			cout << endl;
+
+			builder->optimize();
     	}
 
-    	delete[] order;
+    	double build_time = get_cpu_time() - build_start;
+    	result.build_time += build_time;
+    	result.num_vars = std::max(result.num_vars, builder->num_vars());
+    	result.peak_nodes += builder->peak_num_nodes();
+    	result.num_nodes += builder->num_nodes();
 
-//    	cout << "Reordering to the original order..." << endl;
-//    	builder->reorder(original_order);
-//    	builder->output_status(cout);
-    }
+    	builder->output_status(cout);
 
-//    greedy(*builders[0], *builders[1]);
-//    gradual_greedy(*builders[0], *builders[1]);
+    	if (order_out.is_open()) {
+    		builder->write_variable_order(order_out);
+    	}
 
-//    builders[0]->output_status(cout);
-//    builders[1]->output_status(cout);
+    	if (options.save != nullptr) {
+    		string file = options.save;
+    		if (builders.size() > 1) {
+    			file += "." + to_string(b);
+    		}
+    		if (!builder->save(file.c_str())) {
+    			exit(1);
+    		}
+    	}
 
-#else
-    cout << "Start transforming..." << endl;
-    for (auto& builder : builders) {
-    	builder->set_num_vars(max_num_vars);
-    	builder->initialize(heuristic);
+    	if (options.bench_target != nullptr) {
+    		vector<ReorderTrial> trials;
+    		if (options.shards > 1) {
+    			double start = get_wall_time();
+    			run_sharded_benchmark(builder, options, trials);
+    			cout << "Shards: " << options.shards << ", " << (get_wall_time() - start) << " s" << endl;
+    		}
+    		else {
+    			ReorderBenchmark benchmark(*static_cast<Rebuilder*>(builder), options.seed, options.bench_target);
+    			benchmark.run(0, num, trials);
+    		}
+    		ofstream file;
+    		if (options.results != nullptr) {
+    			file.open(builders.size() > 1 ? string(options.results) + "." + to_string(b) : string(options.results));
+    		}
+    		ReorderBenchmark::write_trials(trials, file.is_open() ? file : cout);
+    		ReorderBenchmark::summarize(trials, cout);
+    		continue;
+    	}
 
-    	builder->build_model();
-//    	builder->output_status(cout);
-    	cout << endl;
+    	if (options.check_rounds > 0) {
+    		Simulator simulator(builder->model());
+    		builder->check_outputs(simulator, options.check_rounds);
+    	}
 
-    	builder->optimize();
+    	if (options.reach != nullptr) {
+    		static_cast<SequentialModelBuilder*>(builder)->compute_reachable_states(options.reach);
+    	}
 
-    	builder->output_status(cout);
+    	if (options.group_bits > 0) {
+    		if (options.group_compare) {
+    			compare_with_binary(*builder, build_time, options);
+    		}
+    		// The other reduction rules are defined on binary variables only
+    		continue;
+    	}
 
     	{
 			double start = get_cpu_time();
@@ -348,8 +673,16 @@ int main(int argc, char* argv[]) {
 			double end = get_cpu_time();
 			cout << "Time: " << (end - start) << " s" << endl;
     	}
+
+    	if (options.index_sets) {
+    		IndexSetModelBuilder* index_set_builder = static_cast<IndexSetModelBuilder*>(builder);
+    		index_set_builder->construct_index_sets(options.jobs);
+    		builder->output_status(cout);
+    		if (options.samples > 0) {
+    			index_set_builder->sample(options.samples);
+    		}
+    	}
     }
-#endif
 
     for (auto& builder : builders) {
     	builder->clean_up();
@@ -357,5 +690,356 @@ int main(int argc, char* argv[]) {
     }
     MEDDLY::cleanup();
 
+    result.total_time = get_cpu_time() - run_start;
     return 0;
 }
+
+// Read a job file with one command line per job (INSTANCE #REORDER HEURISTIC [OPTIONS]) and run
+// the jobs in a pool of worker processes, each with its own MEDDLY instance. Every netlist is
+// parsed when its first job is dispatched, shared by the jobs that build it and released after
+// the last one.
+int run_batch(const Options& options)
+{
+    ifstream in(options.batch);
+    if (!in) {
+    	cout << "Cannot open " << options.batch << endl;
+    	return 1;
+    }
+
+    // Options refer to the tokens, which stay in place for the whole batch
+    vector<vector<string>> lines;
+    string line;
+    while (getline(in, line)) {
+    	istringstream tokens(line);
+    	vector<string> job(1, "BlifParser");
+    	string token;
+    	while (tokens >> token) {
+    		job.push_back(token);
+    	}
+    	if (job.size() > 1 && job[1][0] != '#') {
+    		lines.push_back(job);
+    	}
+    }
+
+    size_t num_jobs = lines.size();
+    vector<Options> jobs(num_jobs);
+    vector<string> statuses(num_jobs, "FAILED");
+    vector<RunResult> results(num_jobs, RunResult());
+    // Jobs not dispatched yet per netlist, which is released after its last job
+    unordered_map<string, int> pending;
+    for (size_t j = 0; j < num_jobs; j++) {
+    	vector<char*> argv;
+    	for (auto& token : lines[j]) {
+    		argv.push_back(&token[0]);
+    	}
+    	if (!jobs[j].parse(argv.size(), argv.data()) || jobs[j].batch != nullptr) {
+    		cout << "Invalid job " << j << ": " << lines[j][1] << endl;
+    		statuses[j] = "INVALID";
+    	}
+    	else if (!jobs[j].load) {
+    		pending[netlist_key(jobs[j])]++;
+    	}
+    }
+    unordered_map<string, vector<Model>> netlists;
+    // Netlists that failed to parse fail all their jobs without another attempt
+    unordered_set<string> unparsable;
+
+    double start = get_wall_time();
+    // Running workers and the pipes their results come back through
+    unordered_map<pid_t, pair<size_t, int>> running;
+    size_t next = 0;
+    while (next < num_jobs || !running.empty()) {
+    	while (next < num_jobs && static_cast<int>(running.size()) < options.jobs) {
+    		size_t j = next++;
+    		if (statuses[j] == "INVALID") {
+    			continue;
+    		}
+
+    		// The netlist is parsed when its first job is dispatched
+    		string key = netlist_key(jobs[j]);
+    		if (!jobs[j].load && netlists.find(key) == netlists.end()) {
+    			vector<Model> models;
+    			double start = get_cpu_time();
+    			if (unparsable.find(key) == unparsable.end() && parse_models(jobs[j].instance, jobs[j].models, models)) {
+    				netlists.emplace(key, std::move(models));
+    				cout << "Parsed " << jobs[j].instance << " (" << (get_cpu_time() - start) << " s)" << endl;
+    			}
+    			else {
+    				unparsable.insert(key);
+    				pending[key]--;
+    				cout << "Job " << j << ": FAILED (cannot parse " << jobs[j].instance << ")" << endl;
+    				continue;
+    			}
+    		}
+
+    		int fds[2];
+    		if (pipe(fds) != 0) {
+    			perror("pipe");
+    			exit(1);
+    		}
+    		cout.flush();
+    		fflush(stdout);
+    		pid_t pid = fork();
+    		if (pid < 0) {
+    			perror("fork");
+    			exit(1);
+    		}
+    		if (pid == 0) {
+    			close(fds[0]);
+    			string log = options.log_dir != nullptr ? string(options.log_dir) + "/job" + to_string(j) + ".log" : "/dev/null";
+    			if (freopen(log.c_str(), "w", stdout) == nullptr) {
+    				_exit(1);
+    			}
+
+    			const auto itr = netlists.find(netlist_key(jobs[j]));
+    			vector<Model> models = load_models(jobs[j], itr != netlists.end() ? &itr->second : nullptr);
+    			RunResult result;
+    			int status = run(jobs[j], models, result);
+    			cout.flush();
+    			fflush(stdout);
+    			if (status == 0 && write(fds[1], &result, sizeof(result)) != sizeof(result)) {
+    				status = 1;
+    			}
+    			_exit(status);
+    		}
+    		close(fds[1]);
+    		running.emplace(pid, make_pair(j, fds[0]));
+
+    		// Workers keep their own copy of the netlist
+    		if (!jobs[j].load && --pending[key] == 0) {
+    			netlists.erase(key);
+    		}
+    	}
+
+    	if (running.empty()) {
+    		continue;
+    	}
+    	int status;
+    	pid_t pid = waitpid(-1, &status, 0);
+    	const auto itr = running.find(pid);
+    	if (itr == running.end()) {
+    		continue;
+    	}
+    	size_t j = itr->second.first;
+    	int fd = itr->second.second;
+    	running.erase(itr);
+    	// The result fits in the pipe buffer, so it was written before the worker exited
+    	if (WIFEXITED(status) && WEXITSTATUS(status) == 0
+    			&& read(fd, &results[j], sizeof(results[j])) == sizeof(results[j])) {
+    		statuses[j] = "OK";
+    	}
+    	close(fd);
+    	cout << "Job " << j << ": " << statuses[j] << endl;
+    }
+    double end = get_wall_time();
+    cout << "Batch: " << num_jobs << " jobs, " << options.jobs << " workers, " << (end - start) << " s" << endl;
+
+    ofstream file;
+    if (options.results != nullptr) {
+    	file.open(options.results);
+    }
+    ostream& out = file.is_open() ? file : cout;
+    out << "Job\tInstance\tHeuristic\tStatus\tModels\tVars\tPeakNodes\tNodes\tBuild(s)\tTotal(s)" << endl;
+    for (size_t j = 0; j < num_jobs; j++) {
+    	const RunResult& result = results[j];
+    	out << j << "\t" << lines[j][1] << "\t" << (lines[j].size() > 3 ? lines[j][3] : "") << "\t" << statuses[j] << "\t"
+    			<< result.num_models << "\t" << result.num_vars << "\t" << result.peak_nodes << "\t" << result.num_nodes << "\t"
+    			<< result.build_time << "\t" << result.total_time << endl;
+    }
+
+    return 0;
+}
+
+// Discards everything written to it without allocating
+class NullBuffer : public streambuf
+{
+protected:
+	int overflow(int c) { return c; }
+	streamsize xsputn(const char*, streamsize n) { return n; }
+};
+
+// Count the allocations of every step from parsing to the name lookups of the builders. Apart from
+// parsing and numbering the signals, no step may allocate: accessors return references, models
+// are moved and signals are looked up by views of their names.
+int run_alloc_check(const Options& options)
+{
+    if (get_num_allocations() < 0) {
+    	cout << "Allocations are counted only in builds with COUNT_ALLOCATIONS (make bench)" << endl;
+    	return 1;
+    }
+
+    bool passed = true;
+    auto check = [&passed](const char* step, long allocations, bool expect_none) {
+    	bool ok = !expect_none || allocations == 0;
+    	passed = passed && ok;
+    	cout << step << ": " << allocations << " allocations" << (expect_none ? (ok ? " (PASS)" : " (FAIL)") : "") << endl;
+    };
+
+    long start = get_num_allocations();
+    BlifParser parser;
+    if (!parser.parse(options.instance)) {
+    	return 1;
+    }
+    check("Parse", get_num_allocations() - start, false);
+
+    start = get_num_allocations();
+    vector<Model> models = parser.release_models();
+    check("Release models", get_num_allocations() - start, true);
+
+    // The accesses made by the builders and the simulator
+    start = get_num_allocations();
+    size_t length = 0;
+    for (const auto& model : models) {
+    	length += model.name().size();
+    	for (const auto& input : model.inputs()) {
+    		length += input.size();
+    	}
+    	for (const auto& output : model.outputs()) {
+    		length += output.size();
+    	}
+    	for (const auto& gate : model.gates()) {
+    		length += gate.name().size() + gate.output().size();
+    		for (const auto& input : gate.inputs()) {
+    			length += input.size();
+    		}
+    		for (const auto& row : gate.rows()) {
+    			for (const auto& literal : row) {
+    				length += literal.size();
+    			}
+    		}
+    	}
+    	for (const auto& latch : model.latches()) {
+    		length += latch.input().size() + latch.output().size();
+    	}
+    }
+    check("Accessors", get_num_allocations() - start, true);
+
+    NullBuffer buffer;
+    ostream null_stream(&buffer);
+    start = get_num_allocations();
+    for (const auto& model : models) {
+    	null_stream << model;
+    }
+    check("Print", get_num_allocations() - start, true);
+
+    start = get_num_allocations();
+    vector<Model> moved(std::move(models));
+    check("Move models", get_num_allocations() - start, true);
+
+    // Only the map entries allocate, once per signal
+    long sum = 0;
+    for (const auto& model : moved) {
+    	ModelBuilder builder(model);
+    	builder.set_num_vars(model.inputs().size());
+    	start = get_num_allocations();
+    	builder.create_vars();
+    	long allocations = get_num_allocations() - start;
+    	cout << "# Signals: " << builder.num_signals() << endl;
+    	check("Create variables", allocations, false);
+
+    	start = get_num_allocations();
+    	sum += builder.resolve_gate_signals();
+    	check("Resolve gate signals", get_num_allocations() - start, true);
+    }
+
+    cout << "# Characters: " << length << endl;
+    cout << "# Variable Sum: " << sum << endl;
+    cout << (passed ? "PASS" : "FAIL") << endl;
+    return passed ? 0 : 1;
+}
+
+// Parse the instance once with the gates on the heap and once in arenas, each in a fresh process
+int run_parse_bench(const Options& options)
+{
+    struct ParseResult
+    {
+    	long num_allocations;
+    	long resident;
+    	double parse_time;
+    	double release_time;
+    	long num_gates;
+    };
+
+    const char* VARIANTS[] = {"Heap", "Arena"};
+    ParseResult results[2];
+    for (int v = 0; v < 2; v++) {
+    	int fds[2];
+    	if (pipe(fds) != 0) {
+    		perror("pipe");
+    		exit(1);
+    	}
+    	cout.flush();
+    	fflush(stdout);
+    	pid_t pid = fork();
+    	if (pid < 0) {
+    		perror("fork");
+    		exit(1);
+    	}
+    	if (pid == 0) {
+    		close(fds[0]);
+    		ParseResult result;
+    		long allocations = get_num_allocations();
+    		long resident = get_resident_memory();
+    		double start = get_cpu_time();
+
+    		BlifParser* parser = new BlifParser(v == 1);
+    		if (!parser->parse(options.instance)) {
+    			_exit(1);
+    		}
+
+    		result.parse_time = get_cpu_time() - start;
+    		result.num_allocations = get_num_allocations() - allocations;
+    		result.resident = get_resident_memory() - resident;
+    		result.num_gates = 0;
+    		for (const auto& model : parser->models()) {
+    			result.num_gates += model.gates().size();
+    		}
+
+    		start = get_cpu_time();
+    		delete parser;
+    		result.release_time = get_cpu_time() - start;
+
+    		_exit(write(fds[1], &result, sizeof(result)) == sizeof(result) ? 0 : 1);
+    	}
+    	close(fds[1]);
+    	int status;
+    	bool valid = read(fds[0], &results[v], sizeof(results[v])) == sizeof(results[v]);
+    	close(fds[0]);
+    	waitpid(pid, &status, 0);
+    	if (!valid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    		cout << "Parse benchmark failed" << endl;
+    		return 1;
+    	}
+    }
+
+    // Allocations are counted only in builds with COUNT_ALLOCATIONS (make bench)
+    bool counted = get_num_allocations() >= 0;
+    cout << "Instance: " << options.instance << endl;
+    cout << "Storage\tGates\tAllocations\tRSS(KB)\tParse(s)\tRelease(s)" << endl;
+    for (int v = 0; v < 2; v++) {
+    	cout << VARIANTS[v] << "\t" << results[v].num_gates << "\t" << (counted ? to_string(results[v].num_allocations) : "-") << "\t"
+    			<< results[v].resident / 1024 << "\t" << results[v].parse_time << "\t" << results[v].release_time << endl;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!options.parse(argc, argv)){
+    	return print_usage();
+    }
+
+    if (options.batch != nullptr) {
+    	return run_batch(options);
+    }
+    if (options.parse_bench) {
+    	return run_parse_bench(options);
+    }
+    if (options.alloc_check) {
+    	return run_alloc_check(options);
+    }
+
+    vector<Model> models = load_models(options);
+    RunResult result;
+    return run(options, models, result);
+}
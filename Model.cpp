@@ -0,0 +1,201 @@
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Model.h"
+
+Model Model::cone_of_influence(const vector<string>& outputs) const
+{
+	unordered_map<string, int> drivers;
+	for (size_t i = 0; i < _gates.size(); i++) {
+		drivers.emplace(_gates[i].name(), i);
+	}
+	unordered_map<string, int> latches;
+	for (size_t i = 0; i < _latches.size(); i++) {
+		latches.emplace(_latches[i].output(), i);
+	}
+
+	vector<bool> used_gates(_gates.size(), false);
+	vector<bool> used_latches(_latches.size(), false);
+	unordered_set<string> visited;
+	vector<string> todo(outputs.begin(), outputs.end());
+	while (!todo.empty()) {
+		string signal = todo.back();
+		todo.pop_back();
+		if (!visited.insert(signal).second) {
+			continue;
+		}
+
+		const auto gate = drivers.find(signal);
+		if (gate != drivers.end()) {
+			used_gates[gate->second] = true;
+			for (const auto& input : _gates[gate->second].inputs()) {
+				todo.push_back(input);
+			}
+			continue;
+		}
+
+		const auto latch = latches.find(signal);
+		if (latch != latches.end()) {
+			// The latch output depends on the cone of its input
+			used_latches[latch->second] = true;
+			todo.push_back(_latches[latch->second].input());
+		}
+	}
+
+	Model model;
+	model.name() = _name;
+	model._arena = _arena;
+	for (const auto& input : _inputs) {
+		if (visited.find(input) != visited.end()) {
+			model.inputs().push_back(input);
+		}
+	}
+	model.outputs() = outputs;
+	for (size_t i = 0; i < _gates.size(); i++) {
+		if (used_gates[i]) {
+			model.add_gate() = _gates[i];
+		}
+	}
+	for (size_t i = 0; i < _latches.size(); i++) {
+		if (used_latches[i]) {
+			model.add_latch() = _latches[i];
+		}
+	}
+
+	return model;
+}
+
+void Model::topological_order(int gate, const unordered_map<string, int>& drivers, vector<bool>& visited, vector<int>& order) const
+{
+	if (visited[gate]) {
+		return;
+	}
+	visited[gate] = true;
+
+	for (const auto& input : _gates[gate].inputs()) {
+		const auto driver = drivers.find(input);
+		if (driver != drivers.end()) {
+			topological_order(driver->second, drivers, visited, order);
+		}
+	}
+	order.push_back(gate);
+}
+
+void Model::propagate_constants(int& num_simplified, int& num_removed)
+{
+	num_simplified = 0;
+	num_removed = 0;
+
+	unordered_map<string, int> drivers;
+	for (size_t i = 0; i < _gates.size(); i++) {
+		drivers.emplace(_gates[i].name(), i);
+	}
+
+	vector<int> order;
+	vector<bool> visited(_gates.size(), false);
+	for (size_t i = 0; i < _gates.size(); i++) {
+		topological_order(i, drivers, visited, order);
+	}
+
+	unordered_map<string, bool> constants;
+	vector<vector<string> > rows;
+	for (const auto& i : order) {
+		Gate& gate = _gates[i];
+		if (gate.is_constant()) {
+			constants.emplace(gate.name(), gate.constant());
+			continue;
+		}
+
+		bool depends = false;
+		for (const auto& input : gate.inputs()) {
+			if (constants.find(input) != constants.end()) {
+				depends = true;
+				break;
+			}
+		}
+		if (!depends) {
+			continue;
+		}
+
+		// Drop false literals' cubes and true literals; an empty cube makes the cover true
+		rows.clear();
+		bool tautology = false;
+		for (const auto& row : gate.rows()) {
+			vector<string> cube;
+			bool keep = true;
+			for (const auto& literal : row) {
+				bool complement = literal[0] == '-';
+				const auto constant = constants.find(complement ? literal.substr(1) : literal);
+				if (constant == constants.end()) {
+					cube.push_back(literal);
+				}
+				else if (constant->second == complement) {
+					keep = false;
+					break;
+				}
+			}
+			if (!keep) {
+				continue;
+			}
+			if (cube.empty()) {
+				tautology = true;
+				break;
+			}
+			rows.push_back(cube);
+		}
+
+		num_simplified++;
+		bool complement = gate.output()[0] == '-';
+		if (tautology || rows.empty()) {
+			gate.inputs().clear();
+			gate.rows().clear();
+			gate.output() = gate.name();
+			gate.constant() = tautology != complement;
+			constants.emplace(gate.name(), gate.constant());
+			continue;
+		}
+
+		vector<string> inputs;
+		for (const auto& input : gate.inputs()) {
+			if (constants.find(input) == constants.end()) {
+				inputs.push_back(input);
+			}
+		}
+		gate.inputs().assign(inputs.begin(), inputs.end());
+		gate.rows().clear();
+		for (const auto& row : rows) {
+			gate.add_row(row);
+		}
+	}
+
+	if (constants.empty()) {
+		return;
+	}
+
+	// Keep the gates still reachable from the outputs and latch inputs
+	vector<bool> used(_gates.size(), false);
+	vector<string> todo(_outputs.begin(), _outputs.end());
+	for (const auto& latch : _latches) {
+		todo.push_back(latch.input());
+	}
+	while (!todo.empty()) {
+		const auto driver = drivers.find(todo.back());
+		todo.pop_back();
+		if (driver == drivers.end() || used[driver->second]) {
+			continue;
+		}
+		used[driver->second] = true;
+		for (const auto& input : _gates[driver->second].inputs()) {
+			todo.push_back(input);
+		}
+	}
+
+	vector<Gate> gates;
+	for (size_t i = 0; i < _gates.size(); i++) {
+		if (used[i]) {
+			gates.push_back(_gates[i]);
+		}
+	}
+	num_removed = _gates.size() - gates.size();
+	_gates.swap(gates);
+}
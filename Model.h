@@ -1,8 +1,11 @@
 #ifndef MODEL_H_
 #define MODEL_H_
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 
+#include "Arena.h"
 #include "Gate.h"
 #include "Latch.h"
 
@@ -15,18 +18,24 @@ private:
 	vector<string> _outputs;
 	vector<Gate> _gates;
 	vector<Latch> _latches;
+	// Storage of the gates, none if they use the heap
+	shared_ptr<Arena> _arena;
 
 public:
 	string& name() { return _name; };
-	string name() const { return _name; };
+	const string& name() const { return _name; };
 	vector<string>& inputs() { return _inputs; };
 	const vector<string>& inputs() const { return _inputs; };
 	vector<string>& outputs() { return _outputs; };
 	const vector<string>& outputs() const { return _outputs; };
 
+	// Gates added from now on allocate from a new arena
+	void create_arena() { _arena = make_shared<Arena>(); }
+	const shared_ptr<Arena>& arena() const { return _arena; }
+
 	Gate& add_gate()
 	{
-		_gates.push_back(Gate());
+		_gates.emplace_back(ArenaAllocator<string>(_arena));
 		return _gates.back();
 	}
 	const vector<Gate>& gates() const { return _gates; };
@@ -38,6 +47,16 @@ public:
 	}
 	const vector<Latch>& latches() const { return _latches; };
 
+	// Restrict the model to the given outputs and the logic they depend on
+	Model cone_of_influence(const vector<string>& outputs) const;
+	// Fold constant gates into their fanouts and, if there were any, drop every gate unreachable
+	// from the outputs and latch inputs. Counts the gates rewritten by the folding and the
+	// gates dropped, dead before or after it.
+	void propagate_constants(int& num_simplified, int& num_removed);
+
+private:
+	void topological_order(int gate, const unordered_map<string, int>& drivers, vector<bool>& visited, vector<int>& order) const;
+
 	friend ostream& operator<<(ostream& out, const Model& model)
 	{
 		out << "Model: " << model.name() <<endl;
@@ -1,16 +1,49 @@
 #include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
 #include <unordered_map>
 #include <algorithm>
 
 #include <meddly.h>
+#include <meddly_expert.h>
 
 #include "ModelBuilder.h"
 #include "System.h"
 
 default_random_engine ModelBuilder::RANDOM_ENGINE;
 
+static const char CHECKPOINT_MAGIC[8] = {'B', 'L', 'I', 'F', 'B', 'D', 'D', '1'};
+
+static void write_int(FILE* file, int32_t value)
+{
+	fwrite(&value, sizeof(value), 1, file);
+}
+
+static void write_string(FILE* file, const string& str)
+{
+	write_int(file, str.size());
+	fwrite(str.data(), 1, str.size(), file);
+}
+
+static bool read_int(FILE* file, int32_t& value)
+{
+	return fread(&value, sizeof(value), 1, file) == 1;
+}
+
+static bool read_string(FILE* file, string& str)
+{
+	int32_t size;
+	if (!read_int(file, size) || size < 0) {
+		return false;
+	}
+	str.resize(size);
+	return size == 0 || fread(&str[0], 1, size, file) == static_cast<size_t>(size);
+}
+
 ModelBuilder::ModelBuilder(const Model& model)
-	: _model(model), _domain(nullptr), _mdd_forest(nullptr)
+	: _num_steps(0), _num_applies(0), _num_table_gates(0), _use_truth_tables(false), _model(model), _domain(nullptr),
+	  _mdd_forest(nullptr)
 {
 }
 
@@ -29,8 +62,25 @@ void ModelBuilder::initialize(const char* heuristic)
 	cout << "# Outputs: " << _model.outputs().size() << endl;
 	cout << "# Gates: " << _model.gates().size() << endl;
 
+	create_forest(heuristic);
+
+	limit = 100000;
+	_purge_limit = 0;
+	_num_purges = 0;
+
+	create_vars();
+
+	MEDDLY::dd_edge bdd(_mdd_forest);
+	_mdd_forest->createEdge(false, bdd);
+	_bdds.assign(1 + _num_signals, bdd);
+}
+
+void ModelBuilder::create_forest(const char* heuristic)
+{
 	int* bounds = new int[num_vars()];
-	std::fill_n(bounds, num_vars(), 2);
+	for (int i = 0; i < num_vars(); i++) {
+		bounds[i] = variable_bound(i + 1);
+	}
 
 	_domain = MEDDLY::createDomainBottomUp(bounds, num_vars());
 
@@ -65,15 +115,15 @@ void ModelBuilder::initialize(const char* heuristic)
 	else if (strcmp(heuristic, "REBUILD") == 0) {
 		;
 	}
+	else if (strcmp(heuristic, "HYBRID") == 0) {
+		// Used whenever the in-place reordering is chosen
+		p.setLARC();
+	}
 	else {
 		exit(-1);
 	}
 
 	_mdd_forest = _domain->createForest(false, MEDDLY::forest::BOOLEAN, MEDDLY::forest::MULTI_TERMINAL, p);
-
-	limit = 100000;
-
-	create_vars();
 }
 
 void ModelBuilder::create_vars()
@@ -84,44 +134,40 @@ void ModelBuilder::create_vars()
 		_vars.emplace(input, var);
 	}
 
-	assert(var <= _num_vars);
+	assert(var <= num_input_signals());
 
-	var = _num_vars;
+	var = num_input_signals();
 	for (auto& gate : _model.gates()){
 		for(auto& input : gate.inputs()) {
-			string name = get_name(input);
-			if(_vars.find(name) == _vars.end()) {
+			boost::string_ref name = get_name(input);
+			if(find_var(name) == 0) {
 				var++;
-				_vars.emplace(name, var);
+				_vars.emplace(name.to_string(), var);
 			}
 		}
 
-		string name = get_name(gate.output());
-		if(_vars.find(name) == _vars.end()) {
+		boost::string_ref name = get_name(gate.output());
+		if(find_var(name) == 0) {
 			var++;
-			_vars.emplace(name, var);
+			_vars.emplace(name.to_string(), var);
 		}
 	}
 
 	for (auto& latch : _model.latches()){
-		string name = get_name(latch.input());
-		if (_vars.find(name) == _vars.end()) {
+		boost::string_ref name = get_name(latch.input());
+		if (find_var(name) == 0) {
 			var++;
-			_vars.emplace(name, var);
+			_vars.emplace(name.to_string(), var);
 		}
 
 		name = get_name(latch.output());
-		if (_vars.find(name) == _vars.end()) {
+		if (find_var(name) == 0) {
 			var++;
-			_vars.emplace(name, var);
+			_vars.emplace(name.to_string(), var);
 		}
 	}
 
 	_num_signals = var;
-
-	MEDDLY::dd_edge bdd(_mdd_forest);
-	_mdd_forest->createEdge(false, bdd);
-	_bdds.assign(1 + var, bdd);
 }
 
 void ModelBuilder::examine_dependency(const Gate* gate, const vector<const Gate*>& gates, vector<int>& order, vector<int>& refs)
@@ -129,7 +175,8 @@ void ModelBuilder::examine_dependency(const Gate* gate, const vector<const Gate*
 	assert(gate != nullptr);
 
 	for (const auto& input : gate->inputs()) {
-		int input_var = get_var(input);
+		bool complement = false;
+		int input_var = resolve(get_var(input), complement);
 		if (refs[input_var] > 0) {
 			refs[input_var]++;
 			continue;
@@ -148,7 +195,7 @@ void ModelBuilder::examine_dependency(const Gate* gate, const vector<const Gate*
 	refs[output_var]++;
 }
 
-void ModelBuilder::build_model()
+bool ModelBuilder::build_model(int max_steps, double time_limit)
 {
 	vector<const Gate*> gate_ptrs(num_signals() + 1, nullptr);
 	for (auto& gate : _model.gates()) {
@@ -158,39 +205,111 @@ void ModelBuilder::build_model()
 	// Determine the building order
 	vector<int> order;
 	vector<int> refs(num_signals() + 1, 0);
-	for (auto& output : _model.outputs()) {
-		if(gate_ptrs[get_var(get_name(output))] != nullptr) {
-			examine_dependency(gate_ptrs[get_var(get_name(output))], gate_ptrs, order, refs);
+	vector<string> targets;
+	collect_targets(targets);
+	for (auto& output : targets) {
+		bool complement = false;
+		int output_var = resolve(get_var(get_name(output)), complement);
+		if(gate_ptrs[output_var] != nullptr) {
+			examine_dependency(gate_ptrs[output_var], gate_ptrs, order, refs);
 		}
+		else if(refs[output_var] == 0 && output_var <= num_input_signals()) {
+			order.push_back(output_var);
+			refs[output_var]++;
+		}
+	}
+
+	if (max_steps < 0) {
+		max_steps = max<int>(1, order.size() / TRIAL_FRACTION);
 	}
 
 	MEDDLY::dd_edge bdd(_mdd_forest);
 	_mdd_forest->createEdge(false, bdd);
 	_bdds.assign(_bdds.size(), bdd);
 
+	if (_use_truth_tables && _gate_recipes.empty()) {
+		prepare_recipes(gate_ptrs);
+	}
+	_num_applies = 0;
+	_num_table_gates = 0;
+
+	double start_time = get_cpu_time();
+	_purge_limit = _mdd_forest->getCurrentNumNodes() * _cache_policy.growth;
+
+	vector<bool> built(num_signals() + 1, false);
+	int num_confirmed = 0;
+	int num_refuted = 0;
+	bool completed = true;
+	_num_steps = 0;
 	for(auto& i : order) {
+		if ((max_steps > 0 && _num_steps >= max_steps) || (time_limit > 0 && get_cpu_time() - start_time > time_limit)) {
+			completed = false;
+			break;
+		}
+
 		if(gate_ptrs[i] == nullptr) {
 			build_input(i);
 		}
 		else {
 			build_gate(*gate_ptrs[i], refs);
+
+			if (!_candidates.empty() && _candidates[i] != 0) {
+				// An unproven candidate cannot reuse its representative, so it is built in full
+				// and only checked against it afterwards; canonical edges share the nodes anyway
+				int rep = _candidates[i];
+				if (built[rep] && refs[rep] > 0) {
+					MEDDLY::dd_edge rep_bdd = _bdds[rep];
+					if (_equivalent_complements[i]) {
+						MEDDLY::apply(MEDDLY::COMPLEMENT, rep_bdd, rep_bdd);
+					}
+					if (rep_bdd == _bdds[i]) {
+						num_confirmed++;
+					}
+					else {
+						num_refuted++;
+					}
+				}
+			}
 		}
+		built[i] = true;
 
 		output_status(cout);
+		maintain_cache();
 
 		if(_mdd_forest->getCurrentNumNodes() > limit) {
 			optimize();
 			limit = _mdd_forest->getCurrentNumNodes() * 2;
 		}
+		_num_steps++;
 	}
 
-	for(auto& output : _model.outputs()) {
-		int var = get_var(output);
-		_output_bdds.emplace(output, _bdds[var]);
+	if (completed) {
+		store_bdds();
+	}
+	else {
+		// The BDDs built so far are kept for the caller to reorder and release
+		cout << "Build stopped after " << _num_steps << " of " << order.size() << " steps" << endl;
 	}
 	cout << endl;
 
-	_bdds.clear();
+	if (!_candidates.empty()) {
+		cout << "Equivalence: " << num_confirmed << " candidates confirmed, " << num_refuted << " refuted after their build" << endl;
+	}
+
+	double end_time = get_cpu_time();
+	cout << "Build: " << (end_time - start_time) << " s" << endl;
+	cout << "# Apply Calls: " << _num_applies << endl;
+	if (_use_truth_tables) {
+		cout << "# Truth Table Gates: " << _num_table_gates << " (" << _recipes.size() << " recipes)" << endl;
+	}
+	cout << "# Purges: " << _num_purges << endl;
+	MEDDLY::FILE_output out(stdout);
+	MEDDLY::operation::showAllComputeTables(out, 1);
+
+	if (completed) {
+		_bdds.clear();
+	}
+	return completed;
 
 //	vector<MEDDLY::dd_edge> bdds;
 //	for(auto& gate : model.gates()) {
@@ -225,6 +344,140 @@ void ModelBuilder::build_model()
 //	bdd = bdds.front();
 }
 
+void ModelBuilder::find_equivalences(int rounds)
+{
+	cout << "Finding Equivalences..." << endl;
+	double start_time = get_cpu_time();
+
+	Simulator simulator(_model);
+
+	// Primary inputs and gate outputs, in simulator numbering
+	vector<int> signals;
+	for (const auto& input : _model.inputs()) {
+		signals.push_back(simulator.signal(input));
+	}
+	for (const auto& gate : _model.gates()) {
+		signals.push_back(simulator.signal(gate.name()));
+	}
+
+	const vector<string>& inputs = _model.inputs();
+	const vector<Gate>& gates = _model.gates();
+	auto name_of = [&inputs, &gates](size_t i) {
+		return i < inputs.size() ? inputs[i] : gates[i - inputs.size()].name();
+	};
+
+	vector<vector<Simulator::word> > signatures(signals.size());
+	for (int r = 0; r < rounds; r++) {
+		simulator.randomize();
+		simulator.simulate();
+		for (size_t i = 0; i < signals.size(); i++) {
+			const Simulator::word* values = simulator.values(signals[i]);
+			signatures[i].insert(signatures[i].end(), values, values + Simulator::NUM_WORDS);
+		}
+	}
+
+	// Normalize the polarity so that a signal and its complement collide
+	vector<bool> flipped(signals.size(), false);
+	unordered_map<size_t, vector<int> > buckets;
+	vector<vector<int> > classes;
+	for (size_t i = 0; i < signals.size(); i++) {
+		if (!signatures[i].empty() && (signatures[i][0] & 1)) {
+			flipped[i] = true;
+			for (auto& word : signatures[i]) {
+				word = ~word;
+			}
+		}
+
+		size_t hash = 0;
+		for (const auto& word : signatures[i]) {
+			hash ^= std::hash<Simulator::word>()(word) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+		}
+
+		vector<int>& bucket = buckets[hash];
+		bool found = false;
+		for (const auto& c : bucket) {
+			if (signatures[classes[c].front()] == signatures[i]) {
+				classes[c].push_back(i);
+				found = true;
+				break;
+			}
+		}
+		if (!found) {
+			bucket.push_back(classes.size());
+			classes.push_back(vector<int>(1, i));
+		}
+	}
+
+	_equivalents.assign(num_signals() + 1, 0);
+	_equivalent_complements.assign(num_signals() + 1, false);
+	_candidates.assign(num_signals() + 1, 0);
+
+	int num_classes = 0;
+	int num_proven = 0;
+	int num_candidates = 0;
+	for (const auto& members : classes) {
+		if (members.size() < 2) {
+			continue;
+		}
+		num_classes++;
+
+		// The member with the shallowest cone represents the class
+		int rep = members.front();
+		for (const auto& m : members) {
+			if (simulator.level(signals[m]) < simulator.level(signals[rep])) {
+				rep = m;
+			}
+		}
+
+		int rep_var = get_var(name_of(rep));
+		for (const auto& m : members) {
+			if (m == rep) {
+				continue;
+			}
+			int var = get_var(name_of(m));
+			bool complement = flipped[m] != flipped[rep];
+			_equivalent_complements[var] = complement;
+			if (simulator.prove_equivalent(signals[rep], signals[m], complement, EXHAUSTIVE_SUPPORT)) {
+				_equivalents[var] = rep_var;
+				num_proven++;
+			}
+			else {
+				_candidates[var] = rep_var;
+				num_candidates++;
+			}
+		}
+	}
+
+	double end_time = get_cpu_time();
+	cout << "# Classes: " << num_classes << endl;
+	cout << "# Proven: " << num_proven << endl;
+	cout << "# Candidates: " << num_candidates << endl;
+	cout << (end_time - start_time) << " s" << endl;
+}
+
+MEDDLY::dd_edge ModelBuilder::get_bdd(const string& signal)
+{
+	bool complement = false;
+	int var = resolve(get_var(signal), complement);
+	MEDDLY::dd_edge bdd = _bdds[var];
+	if (complement) {
+		MEDDLY::apply(MEDDLY::COMPLEMENT, bdd, bdd);
+	}
+	return bdd;
+}
+
+void ModelBuilder::collect_targets(vector<string>& targets) const
+{
+	targets = _model.outputs();
+}
+
+void ModelBuilder::store_bdds()
+{
+	for (const auto& output : _model.outputs()) {
+		_output_bdds.emplace(output, get_bdd(output));
+	}
+}
+
 void ModelBuilder::build_input(int var)
 {
 	cout << "Building Input " << var << endl;
@@ -240,31 +493,47 @@ void ModelBuilder::build_gate(const Gate& gate, vector<int>& refs)
 	cout << "Building Gate " << gate.name() << endl;
 
 	MEDDLY::dd_edge bdd(_mdd_forest);
-	_mdd_forest->createEdge(false, bdd);
+	_mdd_forest->createEdge(gate.is_constant() && gate.constant(), bdd);
 
 //	MEDDLY::dd_edge false_bdd(_mdd_forest);
 //	_mdd_forest->createEdge(false, false_bdd);
 
-	for (const auto& row : gate.rows()) {
-		MEDDLY::dd_edge bdd1(_mdd_forest);
-		_mdd_forest->createEdge(true, bdd1);
-
-		for(auto& signal : row) {
-			int input_var = _vars.find(get_name(signal))->second;
-
-			MEDDLY::dd_edge bdd2 = _bdds[input_var];
-//			assert(bdd2 != false_bdd);
-			if(is_complement(signal)) {
-				MEDDLY::apply(MEDDLY::COMPLEMENT, bdd2, bdd2);
+	int output_var = get_var(get_name(gate.output()));
+	bool complement_output = is_complement(gate.output());
+	const ShannonRecipe* recipe = _gate_recipes.empty() ? nullptr : _gate_recipes[output_var];
+	if (recipe != nullptr) {
+		// The truth table already accounts for the complemented output
+		build_from_recipe(gate, *recipe, bdd);
+		complement_output = _gate_complements[output_var];
+		_num_table_gates++;
+	}
+	else {
+		for (const auto& row : gate.rows()) {
+			MEDDLY::dd_edge bdd1(_mdd_forest);
+			_mdd_forest->createEdge(true, bdd1);
+
+			for(auto& signal : row) {
+				bool complement = is_complement(signal);
+				int input_var = signal_var(signal, complement);
+
+				MEDDLY::dd_edge bdd2 = _bdds[input_var];
+//				assert(bdd2 != false_bdd);
+				if(complement) {
+					MEDDLY::apply(MEDDLY::COMPLEMENT, bdd2, bdd2);
+					_num_applies++;
+				}
+				MEDDLY::apply(MEDDLY::INTERSECTION, bdd1, bdd2, bdd1);
+				_num_applies++;
 			}
-			MEDDLY::apply(MEDDLY::INTERSECTION, bdd1, bdd2, bdd1);
-		}
 
-		MEDDLY::apply(MEDDLY::UNION, bdd, bdd1, bdd);
+			MEDDLY::apply(MEDDLY::UNION, bdd, bdd1, bdd);
+			_num_applies++;
+		}
 	}
 
 	for (auto& input : gate.inputs()) {
-		int input_var = _vars.find(get_name(input))->second;
+		bool complement = false;
+		int input_var = signal_var(input, complement);
 		assert(refs[input_var] > 0);
 		refs[input_var]--;
 		if (refs[input_var] == 0) {
@@ -273,15 +542,218 @@ void ModelBuilder::build_gate(const Gate& gate, vector<int>& refs)
 		}
 	}
 
-	int output_var = _vars.find(get_name(gate.output()))->second;
-	if (is_complement(gate.output())) {
+	if (complement_output) {
 		MEDDLY::apply(MEDDLY::COMPLEMENT, bdd, bdd);
+		_num_applies++;
 	}
 	_bdds[output_var] = bdd;
 
 	cout << _mdd_forest->getCurrentNumNodes() << endl;
 }
 
+long ModelBuilder::resolve_gate_signals() const
+{
+	long sum = 0;
+	for (const auto& gate : _model.gates()) {
+		sum += get_var(get_name(gate.output()));
+		for (const auto& row : gate.rows()) {
+			for (const auto& signal : row) {
+				bool complement = is_complement(signal);
+				sum += signal_var(signal, complement);
+			}
+		}
+		for (const auto& input : gate.inputs()) {
+			bool complement = false;
+			sum += signal_var(input, complement);
+		}
+	}
+	return sum;
+}
+
+void ModelBuilder::prepare_recipes(const vector<const Gate*>& gates)
+{
+	_gate_recipes.assign(gates.size(), nullptr);
+	_gate_complements.assign(gates.size(), false);
+	for (size_t var = 0; var < gates.size(); var++) {
+		const Gate* gate = gates[var];
+		if (gate == nullptr || gate->is_constant() || gate->inputs().size() > static_cast<size_t>(TruthTable::MAX_INPUTS)) {
+			continue;
+		}
+
+		// Apply calls of the cover: one intersection per literal, one union per cube
+		int cover_applies = is_complement(gate->output());
+		for (const auto& row : gate->rows()) {
+			for (const auto& literal : row) {
+				cover_applies += is_complement(literal) ? 2 : 1;
+			}
+			cover_applies++;
+		}
+
+		TruthTable table = TruthTable::of_gate(*gate);
+		bool complement = table.get(0);
+		if (complement) {
+			table = table.complement();
+		}
+		auto itr = _recipes.find(table);
+		if (itr == _recipes.end()) {
+			itr = _recipes.emplace(table, ShannonRecipe(table)).first;
+		}
+		if (itr->second.num_applies + complement < cover_applies) {
+			_gate_recipes[var] = &itr->second;
+			_gate_complements[var] = complement;
+		}
+	}
+}
+
+void ModelBuilder::build_from_recipe(const Gate& gate, const ShannonRecipe& recipe, MEDDLY::dd_edge& bdd)
+{
+	const Gate::Signals& inputs = gate.inputs();
+
+	// Input BDDs and their complements, computed on first use
+	vector<MEDDLY::dd_edge> literals(2 * inputs.size(), bdd);
+	vector<bool> ready(2 * inputs.size(), false);
+	auto literal = [&](int input, bool negative) -> const MEDDLY::dd_edge& {
+		int l = 2 * input + negative;
+		if (!ready[l]) {
+			bool complement = negative;
+			int var = resolve(get_var(inputs[input]), complement);
+			literals[l] = _bdds[var];
+			if (complement) {
+				MEDDLY::apply(MEDDLY::COMPLEMENT, literals[l], literals[l]);
+				_num_applies++;
+			}
+			ready[l] = true;
+		}
+		return literals[l];
+	};
+
+	MEDDLY::dd_edge false_bdd(_mdd_forest);
+	_mdd_forest->createEdge(false, false_bdd);
+	MEDDLY::dd_edge true_bdd(_mdd_forest);
+	_mdd_forest->createEdge(true, true_bdd);
+	vector<MEDDLY::dd_edge> results(recipe.steps.size(), false_bdd);
+	auto operand = [&](int o) -> const MEDDLY::dd_edge& {
+		return o == ShannonRecipe::FALSE_OPERAND ? false_bdd : (o == ShannonRecipe::TRUE_OPERAND ? true_bdd : results[o]);
+	};
+
+	for (size_t s = 0; s < recipe.steps.size(); s++) {
+		const ShannonRecipe::Step& step = recipe.steps[s];
+		MEDDLY::dd_edge& result = results[s];
+		if (step.high < 0 && step.low < 0) {
+			result = literal(step.input, step.high == ShannonRecipe::FALSE_OPERAND);
+			continue;
+		}
+
+		if (step.high == ShannonRecipe::TRUE_OPERAND) {
+			MEDDLY::apply(MEDDLY::UNION, literal(step.input, false), operand(step.low), result);
+		}
+		else if (step.high == ShannonRecipe::FALSE_OPERAND) {
+			MEDDLY::apply(MEDDLY::INTERSECTION, literal(step.input, true), operand(step.low), result);
+		}
+		else if (step.low == ShannonRecipe::FALSE_OPERAND) {
+			MEDDLY::apply(MEDDLY::INTERSECTION, literal(step.input, false), operand(step.high), result);
+		}
+		else if (step.low == ShannonRecipe::TRUE_OPERAND) {
+			MEDDLY::apply(MEDDLY::UNION, literal(step.input, true), operand(step.high), result);
+		}
+		else {
+			MEDDLY::dd_edge low(_mdd_forest);
+			MEDDLY::apply(MEDDLY::INTERSECTION, literal(step.input, true), operand(step.low), low);
+			MEDDLY::apply(MEDDLY::INTERSECTION, literal(step.input, false), operand(step.high), result);
+			MEDDLY::apply(MEDDLY::UNION, result, low, result);
+			_num_applies += 2;
+		}
+		_num_applies++;
+	}
+
+	bdd = operand(recipe.result);
+}
+
+string ModelBuilder::select_heuristic(const vector<string>& heuristics, const vector<string>& order, int max_steps, double time_limit)
+{
+	cout << "Selecting a Heuristic..." << endl;
+
+	struct Trial
+	{
+		string heuristic;
+		bool completed;
+		int num_steps;
+		long peak_nodes;
+		long num_nodes;
+		double time;
+	};
+	vector<Trial> trials;
+	for (const auto& heuristic : heuristics) {
+		double start_time = get_cpu_time();
+		initialize(heuristic.c_str());
+		// Trials start from the order of the final build
+		if (!order.empty() && !set_variable_order(order)) {
+			clean_up();
+			return "";
+		}
+		Trial trial;
+		trial.heuristic = heuristic;
+		trial.completed = build_model(max_steps, time_limit);
+		// The heuristics differ only in how they reorder, which a prefix may never trigger
+		optimize();
+		_bdds.clear();
+		trial.time = get_cpu_time() - start_time;
+		trial.num_steps = _num_steps;
+		trial.peak_nodes = _mdd_forest->getPeakNumNodes();
+		trial.num_nodes = _mdd_forest->getCurrentNumNodes();
+		trials.push_back(trial);
+	}
+	clean_up();
+
+	// Trials that built the whole prefix are compared by nodes after reordering and then time;
+	// they beat the others, which are compared by progress first
+	auto better = [](const Trial& x, const Trial& y) {
+		if (x.completed != y.completed) {
+			return x.completed;
+		}
+		if (!x.completed && x.num_steps != y.num_steps) {
+			return x.num_steps > y.num_steps;
+		}
+		if (x.num_nodes != y.num_nodes) {
+			return x.num_nodes < y.num_nodes;
+		}
+		return x.time < y.time;
+	};
+	const Trial& best = *std::min_element(trials.begin(), trials.end(), better);
+
+	cout << "Heuristic\tSteps\tPeakNodes\tNodes\tTime(s)" << endl;
+	for (const auto& trial : trials) {
+		cout << trial.heuristic << "\t" << trial.num_steps << (trial.completed ? "" : "*") << "\t" << trial.peak_nodes << "\t"
+				<< trial.num_nodes << "\t" << trial.time << endl;
+	}
+	cout << "Selected: " << best.heuristic << "\n" << endl;
+	return best.heuristic;
+}
+
+void ModelBuilder::maintain_cache()
+{
+	switch (_cache_policy.purge) {
+	case CachePolicy::NEVER:
+		break;
+	case CachePolicy::ALWAYS:
+		purge_cache();
+		break;
+	case CachePolicy::GROWTH:
+		if (_mdd_forest->getCurrentNumNodes() > _purge_limit) {
+			static_cast<MEDDLY::expert_forest*>(_mdd_forest)->removeStaleComputeTableEntries();
+			_purge_limit = _mdd_forest->getCurrentNumNodes() * _cache_policy.growth;
+			_num_purges++;
+		}
+		break;
+	}
+}
+
+void ModelBuilder::purge_cache()
+{
+	static_cast<MEDDLY::expert_forest*>(_mdd_forest)->removeAllComputeTableEntries();
+	_num_purges++;
+}
+
 void ModelBuilder::optimize()
 {
 	optimize(_domain->getNumVariables(), 1);
@@ -291,6 +763,9 @@ void ModelBuilder::optimize(int top, int bottom)
 {
 	cout << "Optimize: " << endl;
 	int num = _mdd_forest->getCurrentNumNodes();
+	if (_cache_policy.purge_before_reorder) {
+		purge_cache();
+	}
 	double start_time = get_cpu_time();
 	((MEDDLY::expert_forest*)_mdd_forest)->dynamicReorderVariables(top, bottom);
 	double end_time = get_cpu_time();
@@ -314,11 +789,93 @@ void ModelBuilder::swap_adjacent_variable(int lev)
 void ModelBuilder::reorder(int* order)
 {
 	MEDDLY::expert_forest* f = static_cast<MEDDLY::expert_forest*>(_mdd_forest);
+	if (_cache_policy.purge_before_reorder) {
+		purge_cache();
+	}
 	f->resetPeakNumNodes();
 //	f->resetPeakMemoryUsed();
 	f->reorderVariables(order);
 }
 
+bool ModelBuilder::set_variable_order(const vector<string>& order)
+{
+	vector<int> listed;
+	vector<bool> seen(_num_vars + 1, false);
+	for (const auto& token : order) {
+		int var = 0;
+		const auto itr = _vars.find(token);
+		if (itr != _vars.end()) {
+			var = itr->second;
+		}
+		else if (token.size() > 1 && token[0] == '#' && token.find_first_not_of("0123456789", 1) == string::npos) {
+			// '#' starts a comment in BLIF, so no signal is named like this
+			var = atoi(token.c_str() + 1);
+		}
+		if (var <= 0 || var > _num_vars) {
+			cout << "Unknown variable in order: " << token << endl;
+			return false;
+		}
+		if (!seen[var]) {
+			seen[var] = true;
+			listed.push_back(var);
+		}
+	}
+
+	int* current = new int[_num_vars + 1];
+	current[0] = 0;
+	get_variable_order(current);
+
+	int* target = new int[_num_vars + 1];
+	target[0] = 0;
+	int level = 1;
+	for (const auto& var : listed) {
+		target[level++] = var;
+	}
+	for (int i = 1; i <= _num_vars; i++) {
+		if (!seen[current[i]]) {
+			target[level++] = current[i];
+		}
+	}
+	assert(level == _num_vars + 1);
+	delete[] current;
+
+	double start_time = get_cpu_time();
+	static_cast<MEDDLY::expert_forest*>(_mdd_forest)->reorderVariables(target);
+	double end_time = get_cpu_time();
+	delete[] target;
+
+	cout << "Order: " << listed.size() << " of " << _num_vars << " variables placed (" << (end_time - start_time) << " s)" << endl;
+	return true;
+}
+
+void ModelBuilder::write_variable_order(ostream& out)
+{
+	vector<string> names(_num_vars + 1);
+	for (const auto& var : _vars) {
+		if (var.second <= _num_vars) {
+			names[var.second] = var.first;
+		}
+	}
+
+	int* order = new int[_num_vars + 1];
+	order[0] = 0;
+	get_variable_order(order);
+	for (int i = 1; i <= _num_vars; i++) {
+		if (i > 1) {
+			out << " ";
+		}
+		// Padding variables beyond the inputs of this model have no name
+		if (names[order[i]].empty()) {
+			out << "#" << order[i];
+		}
+		else {
+			out << names[order[i]];
+		}
+	}
+	out << endl;
+	delete[] order;
+}
+
 void ModelBuilder::dfs_order(int* order)
 {
 	vector<const Gate*> gate_ptrs(num_signals() + 1, nullptr);
@@ -337,6 +894,7 @@ void ModelBuilder::dfs_order(int* order)
 	std::shuffle(todo.begin(), todo.end(), RANDOM_ENGINE);
 
 	vector<bool> visited(num_signals() + 1, false);
+	vector<int> inputs;
 
 	order[0] = 0;
 	int last = 1;
@@ -349,17 +907,21 @@ void ModelBuilder::dfs_order(int* order)
 		}
 		visited[signal] = true;
 
-		vector<string> inputs = gate_ptrs[signal]->inputs();
+		inputs.clear();
+		for (const auto& input : gate_ptrs[signal]->inputs()) {
+			inputs.push_back(get_var(input));
+		}
 		std::shuffle(inputs.begin(), inputs.end(), RANDOM_ENGINE);
 
-		for (const auto& input : inputs) {
-			int input_var = get_var(input);
+		for (const auto& input_var : inputs) {
 			if (visited[input_var]) {
 				continue;
 			}
 			else if (gate_ptrs[input_var] == nullptr) {
-				// Primary input
-				order[last++] = input_var;
+				// Primary input; latch outputs and undriven signals are no variables
+				if (input_var <= num_input_signals()) {
+					order[last++] = input_var;
+				}
 				visited[input_var] = true;
 			}
 			else {
@@ -431,8 +993,10 @@ void ModelBuilder::fanin_order(int* order)
 				continue;
 			}
 			else if(gate_ptrs[input_var] == nullptr) {
-				// Primary input
-				order[last++] = input_var;
+				// Primary input; latch outputs and undriven signals are no variables
+				if (input_var <= num_input_signals()) {
+					order[last++] = input_var;
+				}
 				visited[input_var] = true;
 			}
 			else {
@@ -457,6 +1021,11 @@ void ModelBuilder::recursive_tfi_depth(const Gate* gate, const vector<const Gate
 		if (depths[input_var] != -1) {
 			max = std::max(depths[input_var] + 1, max);
 		}
+		else if (gates[input_var] == nullptr) {
+			// Latch outputs and undriven signals are leaves like the inputs
+			depths[input_var] = 0;
+			max = std::max(1, max);
+		}
 		else {
 			recursive_tfi_depth(gates[input_var], gates, depths);
 			max = std::max(depths[input_var] + 1, max);
@@ -791,10 +1360,56 @@ void ModelBuilder::countEdgeLabelsForESR(MEDDLY::forest* forest, const vector<ME
 	delete[] counts;
 }
 
+bool ModelBuilder::check_outputs(Simulator& simulator, int rounds)
+{
+	if (!_model.latches().empty()) {
+		cout << "Check: skipped (sequential model)" << endl;
+		return true;
+	}
+
+	int* vlist = new int[num_vars() + 1];
+	std::fill_n(vlist, num_vars() + 1, 0);
+
+	long mismatches = 0;
+	double start_time = get_cpu_time();
+	for (int r = 0; r < rounds; r++) {
+		simulator.randomize();
+		simulator.simulate();
+
+		for (int p = 0; p < Simulator::NUM_PATTERNS; p++) {
+			std::fill_n(vlist, num_vars() + 1, 0);
+			for (const auto& input : _model.inputs()) {
+				assign_input(vlist, get_var(input), simulator.value(simulator.signal(input), p));
+			}
+			for (const auto& output : _output_bdds) {
+				bool result = false;
+				_mdd_forest->evaluate(output.second, vlist, result);
+				if (result != simulator.value(simulator.signal(output.first), p)) {
+					if (mismatches == 0) {
+						cout << "Check: mismatch on " << output.first << endl;
+					}
+					mismatches++;
+				}
+			}
+		}
+	}
+	double end_time = get_cpu_time();
+
+	delete[] vlist;
+
+	cout << "Check: " << static_cast<long>(rounds) * Simulator::NUM_PATTERNS << " patterns, "
+			<< mismatches << " mismatches" << endl;
+	cout << (end_time - start_time) << " s" << endl;
+	return mismatches == 0;
+}
+
 void ModelBuilder::clean_up()
 {
 	if (_domain != nullptr) {
 		_vars.clear();
+		_equivalents.clear();
+		_equivalent_complements.clear();
+		_candidates.clear();
 		MEDDLY::destroyDomain(_domain);
 	}
 	_domain = nullptr;
@@ -802,10 +1417,138 @@ void ModelBuilder::clean_up()
 	_output_bdds.clear();
 }
 
-void ModelBuilder::output_status(ostream& out)
+bool ModelBuilder::save(const char* file) const
 {
-	static_cast<MEDDLY::expert_forest*>(_mdd_forest)->removeAllComputeTableEntries();
+	FILE* out = fopen(file, "wb");
+	if (out == nullptr) {
+		cout << "Cannot open " << file << endl;
+		return false;
+	}
+
+	double start_time = get_cpu_time();
+
+	fwrite(CHECKPOINT_MAGIC, 1, sizeof(CHECKPOINT_MAGIC), out);
+	write_int(out, _num_vars);
+	write_int(out, _num_signals);
+
+	// Variable at each level, from the bottom
+	const MEDDLY::expert_forest* f = static_cast<const MEDDLY::expert_forest*>(_mdd_forest);
+	for (int i = 1; i <= _num_vars; i++) {
+		write_int(out, f->getVarByLevel(i));
+	}
+
+	write_int(out, _vars.size());
+	for (const auto& var : _vars) {
+		write_string(out, var.first);
+		write_int(out, var.second);
+	}
+
+	vector<MEDDLY::dd_edge> bdds;
+	write_int(out, _output_bdds.size());
+	for (const auto& output : _output_bdds) {
+		write_string(out, output.first);
+		bdds.push_back(output.second);
+	}
+
+	// Node data in the native MEDDLY format, shared nodes written once
+	MEDDLY::FILE_output edges(out);
+	_mdd_forest->writeEdges(edges, bdds.data(), bdds.size());
 
+	// Buffered data may only fail to reach the file when it is closed
+	bool success = !ferror(out);
+	success = fclose(out) == 0 && success;
+	if (!success) {
+		cout << "Cannot write " << file << endl;
+		return false;
+	}
+
+	double end_time = get_cpu_time();
+	cout << "Save: " << file << " (" << bdds.size() << " BDDs, " << (end_time - start_time) << " s)" << endl;
+	return success;
+}
+
+bool ModelBuilder::load(const char* file, const char* heuristic)
+{
+	FILE* in = fopen(file, "rb");
+	if (in == nullptr) {
+		cout << "Cannot open " << file << endl;
+		return false;
+	}
+
+	double start_time = get_cpu_time();
+
+	clean_up();
+
+	char magic[sizeof(CHECKPOINT_MAGIC)];
+	int32_t num_vars;
+	int32_t num_signals;
+	if (fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0
+			|| !read_int(in, num_vars) || !read_int(in, num_signals) || num_vars <= 0) {
+		cout << "Invalid checkpoint: " << file << endl;
+		fclose(in);
+		return false;
+	}
+
+	int* order = new int[num_vars + 1];
+	order[0] = 0;
+	bool valid = true;
+	for (int i = 1; i <= num_vars && valid; i++) {
+		valid = read_int(in, order[i]);
+	}
+
+	int32_t num_entries = 0;
+	valid = valid && read_int(in, num_entries);
+	for (int i = 0; i < num_entries && valid; i++) {
+		string name;
+		int32_t var;
+		valid = read_string(in, name) && read_int(in, var);
+		_vars.emplace(name, var);
+	}
+
+	int32_t num_outputs = 0;
+	vector<string> outputs;
+	valid = valid && read_int(in, num_outputs);
+	for (int i = 0; i < num_outputs && valid; i++) {
+		string name;
+		valid = read_string(in, name);
+		outputs.push_back(name);
+	}
+
+	if (!valid) {
+		cout << "Invalid checkpoint: " << file << endl;
+		delete[] order;
+		_vars.clear();
+		fclose(in);
+		return false;
+	}
+
+	_num_vars = num_vars;
+	_num_signals = num_signals;
+	create_forest(heuristic);
+	static_cast<MEDDLY::expert_forest*>(_mdd_forest)->reorderVariables(order);
+	delete[] order;
+
+	limit = 100000;
+	_purge_limit = 0;
+	_num_purges = 0;
+
+	vector<MEDDLY::dd_edge> bdds(outputs.size(), MEDDLY::dd_edge(_mdd_forest));
+	MEDDLY::FILE_input edges(in);
+	_mdd_forest->readEdges(edges, bdds.data(), bdds.size());
+	fclose(in);
+
+	for (size_t i = 0; i < outputs.size(); i++) {
+		_output_bdds.emplace(outputs[i], bdds[i]);
+	}
+
+	double end_time = get_cpu_time();
+	cout << "Load: " << file << " (" << outputs.size() << " BDDs, " << (end_time - start_time) << " s)" << endl;
+	cout << "# Variables: " << num_vars << endl;
+	return true;
+}
+
+void ModelBuilder::output_status(ostream& out)
+{
 	out << "Model: " << _model.name() << endl;
 	out << "Peak Node: " << _mdd_forest->getPeakNumNodes() << endl;
 	out << "Total Node: " << _mdd_forest->getCurrentNumNodes() << endl;
@@ -4,22 +4,63 @@
 #include <random>
 #include <vector>
 #include <unordered_map>
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <meddly.h>
 #include <meddly_expert.h>
 
 #include "Model.h"
+#include "Simulator.h"
+#include "CachePolicy.h"
+#include "TruthTable.h"
 
 using namespace std;
 
+// Hashes names and views into signals alike, so that a complemented signal
+// is looked up by the name after its '-' without copying it
+struct NameHash
+{
+	size_t operator()(boost::string_ref name) const { return boost::hash_range(name.begin(), name.end()); }
+};
+
+struct NameEqual
+{
+	bool operator()(boost::string_ref x, boost::string_ref y) const { return x == y; }
+};
+
 class ModelBuilder
 {
 protected:
 	static default_random_engine RANDOM_ENGINE;
+	// Largest union support proven equivalent by exhaustive simulation
+	static const int EXHAUSTIVE_SUPPORT = 12;
+	// Share of the building order a heuristic trial builds by default
+	static const int TRIAL_FRACTION = 10;
 
 	long limit;
 
+	CachePolicy _cache_policy;
+	// Node count that triggers the next purge under CachePolicy::GROWTH
+	long _purge_limit;
+	int _num_purges;
+	// Gates and inputs built by the last call to build_model
+	int _num_steps;
+	// Apply calls and gates built from truth tables by the last call to build_model
+	long _num_applies;
+	int _num_table_gates;
+
+	// Build gates of few inputs by Shannon construction when that takes fewer apply calls
+	bool _use_truth_tables;
+	// Recipes by truth table; a function and its complement share one
+	unordered_map<TruthTable, ShannonRecipe, TruthTableHash> _recipes;
+	// Recipe of the gate driving every signal (null if none or not worth it),
+	// and whether it builds the complement of the gate
+	vector<const ShannonRecipe*> _gate_recipes;
+	vector<bool> _gate_complements;
+
 	const Model& _model;
-	unordered_map<string, int> _vars;
+	boost::unordered_map<string, int, NameHash> _vars;
 	// Number of input signals
 	int _num_vars;
 	// Number of input, internal and output signals
@@ -29,38 +70,93 @@ protected:
 	vector<MEDDLY::dd_edge> _bdds;
 	unordered_map<string, MEDDLY::dd_edge> _output_bdds;
 
-	string get_name(string signal);
-	int get_var(string name);
+	// Functional equivalence: representative of every signal (0 if none),
+	// and whether it is equivalent to the complement of its representative
+	vector<int> _equivalents;
+	vector<bool> _equivalent_complements;
+	// Candidates that could not be proven before the build; they are built in full
+	// and only checked against their representative
+	vector<int> _candidates;
 
-	void build_input(int var);
+	boost::string_ref get_name(const string& signal) const;
+	// Variable of a name (0 if none), and of a name known to exist
+	int find_var(boost::string_ref name) const;
+	int get_var(boost::string_ref name) const;
+	// Variable a gate build uses for a signal, complemented or not
+	int signal_var(const string& signal, bool& complement) const;
+	int resolve(int var, bool& complement) const;
+
+	MEDDLY::dd_edge get_bdd(const string& signal);
+	virtual void collect_targets(vector<string>& targets) const;
+	virtual void store_bdds();
+
+	// Signals of the inputs are numbered from 1 up to this, the others follow
+	virtual int num_input_signals() const;
+	// Number of values of a domain variable
+	virtual int variable_bound(int var) const;
+
+	virtual void build_input(int var);
+	// Set the domain variable of an input to the value of its signal in an assignment
+	virtual void assign_input(int* vlist, int var, bool value) const;
 	void build_gate(const Gate& gate, vector<int>& refs);
+	void prepare_recipes(const vector<const Gate*>& gates);
+	void build_from_recipe(const Gate& gate, const ShannonRecipe& recipe, MEDDLY::dd_edge& bdd);
+
+	void maintain_cache();
+	void purge_cache();
+
+	void create_forest(const char* heuristic);
 
 	void examine_dependency(const Gate* gate, const vector<const Gate*>& gates, vector<int>& order, vector<int>& exists);
 
-	bool is_complement(string signal);
+	bool is_complement(const string& signal) const;
 
 public:
 	ModelBuilder(const Model& model);
-	void create_vars();
+	virtual ~ModelBuilder() {}
+
+	// Seed the engine that breaks ties in the ordering heuristics
+	static void seed(unsigned seed);
+	// Number every signal; needs no forest
+	virtual void create_vars();
 	void initialize(const char* heuristic);
 	void build();
-	void build_model();
+	// Build up to max_steps gates and inputs within time_limit seconds (no limit if 0,
+	// a tenth of the order if max_steps is negative), and store the outputs if all were built;
+	// otherwise the signals built so far are kept until the caller clears them
+	bool build_model(int max_steps = 0, double time_limit = 0);
+	void find_equivalences(int rounds);
 	void optimize();
+	// Trial-build a prefix from the given order (if any) with every heuristic under the limits,
+	// reorder it, and return the heuristic leaving the fewest nodes (empty if the order is invalid)
+	string select_heuristic(const vector<string>& heuristics, const vector<string>& order, int max_steps, double time_limit);
 	void optimize(int top, int bottom);
-	void clean_up();
+	virtual void clean_up();
+
+	void set_cache_policy(const CachePolicy& policy);
+	void set_truth_tables(bool use_truth_tables);
 
 	void set_num_vars(int num_vars);
 	int num_vars() const;
-	int actual_num_vars() const;
+	virtual int actual_num_vars() const;
 	void reset_stat();
 
 	int num_signals() const;
+	const Model& model() const;
+	// Look up every signal the gate builds look up, and return the sum of their variables
+	long resolve_gate_signals() const;
 
 	virtual void get_variable_order(int* order);
 	virtual void swap_adjacent_variable(int lev);
 	virtual void reorder(int* order);
 
-	// Static ordering heuristics
+	// Move the listed variables, given by signal name or #number, to the bottom levels
+	// in the listed order; the others keep their relative order above them
+	bool set_variable_order(const vector<string>& order);
+	void write_variable_order(ostream& out);
+
+	// Static ordering heuristics; they list only the input variables in the cones
+	// of the outputs, from order[1] on
 	void dfs_order(int* order);
 
 	void fanin_order(int* order);
@@ -68,6 +164,8 @@ public:
 	void recursive_tfi_depth(const Gate* gate, const vector<const Gate*>& gates, vector<int>& depths);
 
 	int num_nodes() const;
+	long peak_num_nodes() const;
+	long num_applies() const;
 
 	void transform_ESRBDD() const;
 	void transform_ZDD_and_CZDD() const;
@@ -79,23 +177,66 @@ public:
 
 	void countEdgeLabelsForESR(MEDDLY::forest* forest, const vector<MEDDLY::dd_edge>& dds) const;
 
+	// Compare the output BDDs against bit-parallel simulation of the netlist
+	bool check_outputs(Simulator& simulator, int rounds);
+
+	// Checkpoint of the output BDDs, the variable order and the signal map
+	bool save(const char* file) const;
+	bool load(const char* file, const char* heuristic);
+
 	virtual void output_status(ostream& out);
 };
 
-inline string ModelBuilder::get_name(string signal)
+inline boost::string_ref ModelBuilder::get_name(const string& signal) const
 {
+	boost::string_ref name(signal);
 	if(signal[0] == '-'){
-		return signal.substr(1, signal.length()-1);
-	}
-	else{
-		return signal;
+		name.remove_prefix(1);
 	}
+	return name;
+}
+
+inline int ModelBuilder::find_var(boost::string_ref name) const
+{
+	const auto itr = _vars.find(name, NameHash(), NameEqual());
+	return itr == _vars.end() ? 0 : itr->second;
 }
 
-inline int ModelBuilder::get_var(string name)
+inline int ModelBuilder::get_var(boost::string_ref name) const
 {
-	assert(_vars.find(name) != _vars.end());
-	return _vars.find(name)->second;
+	int var = find_var(name);
+	assert(var != 0);
+	return var;
+}
+
+inline int ModelBuilder::signal_var(const string& signal, bool& complement) const
+{
+	return resolve(get_var(get_name(signal)), complement);
+}
+
+inline void ModelBuilder::seed(unsigned seed)
+{
+	RANDOM_ENGINE.seed(seed);
+}
+
+inline void ModelBuilder::set_cache_policy(const CachePolicy& policy)
+{
+	_cache_policy = policy;
+}
+
+inline void ModelBuilder::set_truth_tables(bool use_truth_tables)
+{
+	_use_truth_tables = use_truth_tables;
+	_gate_recipes.clear();
+}
+
+inline int ModelBuilder::resolve(int var, bool& complement) const
+{
+	if (!_equivalents.empty() && _equivalents[var] != 0) {
+		complement = complement != _equivalent_complements[var];
+		return _equivalents[var];
+	}
+	return var;
 }
 
 inline void ModelBuilder::set_num_vars(int num_vars)
@@ -109,6 +250,21 @@ inline int ModelBuilder::num_vars() const
 	return _num_vars;
 }
 
+inline int ModelBuilder::num_input_signals() const
+{
+	return _num_vars;
+}
+
+inline int ModelBuilder::variable_bound(int var) const
+{
+	return 2;
+}
+
+inline void ModelBuilder::assign_input(int* vlist, int var, bool value) const
+{
+	vlist[var] = value;
+}
+
 inline int ModelBuilder::actual_num_vars() const
 {
 	return _model.inputs().size();
@@ -119,18 +275,33 @@ inline int ModelBuilder::num_signals() const
 	return _num_signals;
 }
 
+inline const Model& ModelBuilder::model() const
+{
+	return _model;
+}
+
 inline int ModelBuilder::num_nodes() const
 {
 	return _mdd_forest->getCurrentNumNodes();
 }
 
+inline long ModelBuilder::peak_num_nodes() const
+{
+	return _mdd_forest->getPeakNumNodes();
+}
+
+inline long ModelBuilder::num_applies() const
+{
+	return _num_applies;
+}
+
 inline void ModelBuilder::reset_stat()
 {
 	_mdd_forest->resetPeakNumNodes();
 	//_mdd_forest->resetPeakMemoryUsed();
 }
 
-inline bool ModelBuilder::is_complement(string signal)
+inline bool ModelBuilder::is_complement(const string& signal) const
 {
 	return signal[0] == '-';
 }
@@ -0,0 +1,227 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <boost/algorithm/string.hpp>
+
+#include "Options.h"
+
+Options::Options()
+	: instance(nullptr), num_reorder(0), heuristic(nullptr), check_rounds(0), equiv_rounds(0), aig(false), truth_tables(false), group_bits(0), group_by_order(false), group_compare(false),
+	  reach(nullptr),
+	  index_sets(false), jobs(1), samples(0),
+	  bench_target(nullptr), seed(0), shards(1),
+	  portfolio_steps(-1), portfolio_time(0), order_in(nullptr), order_out(nullptr), save(nullptr), load(false), parse_bench(false), alloc_check(false),
+	  batch(nullptr), results(nullptr), log_dir(nullptr)
+{
+}
+
+bool Options::parse(int argc, char* argv[])
+{
+	int first = 4;
+	if (argc >= 3 && strcmp(argv[1], "--batch") == 0) {
+		batch = argv[2];
+		first = 3;
+	}
+	else if (argc < 4) {
+		return false;
+	}
+	else {
+		instance = argv[1];
+		num_reorder = atoi(argv[2]);
+		heuristic = argv[3];
+	}
+
+	for (int i = first; i < argc; i++) {
+		if (strcmp(argv[i], "--check") == 0 && i + 1 < argc) {
+			check_rounds = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--equiv") == 0 && i + 1 < argc) {
+			equiv_rounds = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--aig") == 0) {
+			aig = true;
+		}
+		else if (strcmp(argv[i], "--outputs") == 0 && i + 1 < argc) {
+			vector<string> names;
+			boost::algorithm::split(names, argv[++i], boost::is_any_of(","), boost::algorithm::token_compress_on);
+			outputs.insert(outputs.end(), names.begin(), names.end());
+		}
+		else if (strcmp(argv[i], "--models") == 0 && i + 1 < argc) {
+			vector<string> names;
+			boost::algorithm::split(names, argv[++i], boost::is_any_of(","), boost::algorithm::token_compress_on);
+			models.insert(models.end(), names.begin(), names.end());
+		}
+		else if (strcmp(argv[i], "--output-regex") == 0 && i + 1 < argc) {
+			output_regex = argv[++i];
+			try {
+				output_pattern.assign(output_regex);
+			}
+			catch (const regex_error& error) {
+				cerr << "Invalid output regex: " << output_regex << " (" << error.what() << ")" << endl;
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--ct-size") == 0 && i + 1 < argc) {
+			cache_policy.max_size = strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--ct-purge") == 0 && i + 1 < argc) {
+			if (!cache_policy.set_purge(argv[++i])) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--ct-growth") == 0 && i + 1 < argc) {
+			cache_policy.growth = atof(argv[++i]);
+			// A forest that need not grow would be purged after every step
+			if (cache_policy.growth <= 1) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--ct-keep-on-reorder") == 0) {
+			cache_policy.purge_before_reorder = false;
+		}
+		else if (strcmp(argv[i], "--truth-tables") == 0) {
+			truth_tables = true;
+		}
+		else if (strcmp(argv[i], "--group-inputs") == 0 && i + 1 < argc) {
+			group_bits = atoi(argv[++i]);
+			if (group_bits < 2 || group_bits > 16) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--group-by") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "name") == 0 || strcmp(argv[i], "order") == 0) {
+				group_by_order = strcmp(argv[i], "order") == 0;
+			}
+			else {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--group-compare") == 0) {
+			group_compare = true;
+		}
+		else if (strcmp(argv[i], "--reach") == 0 && i + 1 < argc) {
+			reach = argv[++i];
+			if (strcmp(reach, "BFS") != 0 && strcmp(reach, "SAT") != 0 && strcmp(reach, "BOTH") != 0) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--index-sets") == 0) {
+			index_sets = true;
+		}
+		else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+			jobs = atoi(argv[++i]);
+			if (jobs < 1) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--sample") == 0 && i + 1 < argc) {
+			samples = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+			results = argv[++i];
+		}
+		else if (strcmp(argv[i], "--log-dir") == 0 && i + 1 < argc) {
+			log_dir = argv[++i];
+		}
+		else if (strcmp(argv[i], "--bench-reorder") == 0 && i + 1 < argc) {
+			bench_target = argv[++i];
+			if (strcmp(bench_target, "RANDOM") != 0 && strcmp(bench_target, "DFS") != 0
+					&& strcmp(bench_target, "FANIN") != 0) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+			shards = atoi(argv[++i]);
+			if (shards < 1) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--portfolio") == 0 && i + 1 < argc) {
+			portfolio.clear();
+			boost::algorithm::split(portfolio, argv[++i], boost::is_any_of(","), boost::algorithm::token_compress_on);
+		}
+		else if (strcmp(argv[i], "--portfolio-steps") == 0 && i + 1 < argc) {
+			portfolio_steps = atoi(argv[++i]);
+			if (portfolio_steps < 0) {
+				return false;
+			}
+		}
+		else if (strcmp(argv[i], "--portfolio-time") == 0 && i + 1 < argc) {
+			portfolio_time = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--parse-bench") == 0) {
+			parse_bench = true;
+		}
+		else if (strcmp(argv[i], "--alloc-check") == 0) {
+			alloc_check = true;
+		}
+		else if (strcmp(argv[i], "--order-in") == 0 && i + 1 < argc) {
+			order_in = argv[++i];
+		}
+		else if (strcmp(argv[i], "--order-out") == 0 && i + 1 < argc) {
+			order_out = argv[++i];
+		}
+		else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) {
+			save = argv[++i];
+		}
+		else if (strcmp(argv[i], "--load") == 0) {
+			load = true;
+		}
+		else {
+			return false;
+		}
+	}
+
+	if ((index_sets && reach != nullptr) || (samples > 0 && !index_sets)
+			|| (bench_target != nullptr && (reach != nullptr || index_sets))
+			|| (shards > 1 && bench_target == nullptr)) {
+		return false;
+	}
+	// Index sets are built by their own builder, which reorders in place only
+	if (index_sets && heuristic != nullptr && (strcmp(heuristic, "REBUILD") == 0 || strcmp(heuristic, "HYBRID") == 0)) {
+		return false;
+	}
+
+	if (portfolio.empty()) {
+		boost::algorithm::split(portfolio, "LI,HI,SD,BU,LC,LM,LARC", boost::is_any_of(","));
+	}
+	// Trials reorder in place, so the rebuilding heuristics and PORTFOLIO itself cannot be tried
+	for (const auto& name : portfolio) {
+		static const char* const TRIAL_HEURISTICS[] = { "LI", "HI", "SD", "BU", "LC", "LM", "RAN", "LARC" };
+		bool known = false;
+		for (const char* trial : TRIAL_HEURISTICS) {
+			known = known || name == trial;
+		}
+		if (!known) {
+			cerr << "Invalid portfolio heuristic: " << name << endl;
+			return false;
+		}
+	}
+	// The selected heuristic is not known before the build
+	if (heuristic != nullptr && strcmp(heuristic, "PORTFOLIO") == 0 && load) {
+		return false;
+	}
+
+	// Multi-valued variables leave the signals of the inputs apart from the domain variables
+	if (group_bits > 0 && (reach != nullptr || index_sets || bench_target != nullptr || save != nullptr
+			|| load || order_in != nullptr || order_out != nullptr
+			|| (heuristic != nullptr && (strcmp(heuristic, "REBUILD") == 0 || strcmp(heuristic, "HYBRID") == 0)))) {
+		return false;
+	}
+	// The binary build of the comparison uses the heuristic as is
+	if (group_compare && (group_bits == 0 || (heuristic != nullptr && strcmp(heuristic, "PORTFOLIO") == 0))) {
+		return false;
+	}
+
+	// A checkpoint holds the output BDDs only, not the netlist
+	if (load && (check_rounds > 0 || (bench_target != nullptr && strcmp(bench_target, "RANDOM") != 0) || equiv_rounds > 0 || aig || reach != nullptr
+			|| !outputs.empty() || !output_regex.empty() || !models.empty())) {
+		return false;
+	}
+
+	return true;
+}
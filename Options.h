@@ -0,0 +1,86 @@
+#ifndef OPTIONS_H_
+#define OPTIONS_H_
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "CachePolicy.h"
+
+using namespace std;
+
+// Command-line options: three positional arguments followed by optional flags
+class Options
+{
+public:
+	const char* instance;
+	int num_reorder;
+	const char* heuristic;
+
+	// Rounds of bit-parallel simulation used to cross-check the built outputs
+	int check_rounds;
+	// Rounds of simulation used to find functionally equivalent signals
+	int equiv_rounds;
+	// Build from the structurally hashed AIG of every model
+	bool aig;
+	// Models of the instance to parse, with the models they instantiate; all if empty
+	vector<string> models;
+	// Outputs to build, by name or by regular expression; all if both are empty
+	vector<string> outputs;
+	string output_regex;
+	// Compiled output_regex, checked while parsing the options
+	regex output_pattern;
+
+	CachePolicy cache_policy;
+	// Build gates of up to 8 inputs from their truth tables
+	bool truth_tables;
+	// Input bits per multi-valued variable (0: binary variables), grouped by bus name or by position
+	int group_bits;
+	bool group_by_order;
+	// Also build the models on binary variables and compare both encodings
+	bool group_compare;
+
+	// Reachability method for sequential models (BFS, SAT or BOTH), none if null
+	const char* reach;
+
+	// Convert the outputs to EV+ index sets after the transformations
+	bool index_sets;
+	// Number of worker processes
+	int jobs;
+	// Assignments per output drawn to check rank and unrank on the index sets
+	int samples;
+
+	// Target orders of the reordering benchmark (RANDOM, DFS or FANIN), none if null
+	const char* bench_target;
+	unsigned seed;
+	// Worker processes sharing the benchmark trials
+	int shards;
+
+	// Heuristics tried on a prefix of the build when HEURISTIC is PORTFOLIO, and the limits of every trial
+	vector<string> portfolio;
+	int portfolio_steps;
+	double portfolio_time;
+
+	// Variable order files read before and written after the build, none if null
+	const char* order_in;
+	const char* order_out;
+
+	// Checkpoint written after the build, none if null
+	const char* save;
+	// INSTANCE is a checkpoint to load instead of a BLIF file
+	bool load;
+
+	// Only benchmark the parser, or only count its allocations
+	bool parse_bench;
+	bool alloc_check;
+
+	// Job file of the batch mode, none if null; INSTANCE, #REORDER and HEURISTIC then come from its lines
+	const char* batch;
+	const char* results;
+	const char* log_dir;
+
+	Options();
+	bool parse(int argc, char* argv[]);
+};
+
+#endif
@@ -1,21 +1,70 @@
+#include <unordered_map>
+
 #include "Rebuilder.h"
+#include "System.h"
 
 Rebuilder::Rebuilder(const Model& model)
-	: ModelBuilder(model)
+	: ModelBuilder(model), _rebuild_peak_nodes(0), _rebuild_peak_memory(0)
 {
 }
 
 void Rebuilder::reorder(int* order)
 {
-	MEDDLY::forest* target_mdd_forest = _domain->createForest(false, MEDDLY::forest::BOOLEAN, MEDDLY::forest::MULTI_TERMINAL);
+	MEDDLY::forest* source_mdd_forest = _mdd_forest;
+	if (_cache_policy.purge_before_reorder) {
+		purge_cache();
+	}
+
+	double start_time = get_cpu_time();
+
+	MEDDLY::forest* target_mdd_forest = _domain->createForest(false, MEDDLY::forest::BOOLEAN,
+			MEDDLY::forest::MULTI_TERMINAL, source_mdd_forest->getPolicies());
 	static_cast<MEDDLY::expert_forest*>(target_mdd_forest)->reorderVariables(order);
-	MEDDLY::global_rebuilder gr(static_cast<MEDDLY::expert_forest*>(_mdd_forest),
-			static_cast<MEDDLY::expert_forest*>(target_mdd_forest));
+	// The rebuilder and the map of rebuilt roots go away before the source forest
+	size_t num_roots = 0;
+	{
+		MEDDLY::global_rebuilder gr(static_cast<MEDDLY::expert_forest*>(source_mdd_forest),
+				static_cast<MEDDLY::expert_forest*>(target_mdd_forest));
+
+		// Outputs sharing a root are rebuilt once
+		unordered_map<MEDDLY::node_handle, MEDDLY::dd_edge> rebuilt;
+		auto rebuild = [&gr, &rebuilt](MEDDLY::dd_edge& edge) {
+			const auto itr = rebuilt.find(edge.getNode());
+			if (itr != rebuilt.end()) {
+				edge = itr->second;
+			}
+			else {
+				MEDDLY::node_handle node = edge.getNode();
+				edge = gr.rebuild(edge);
+				rebuilt.emplace(node, edge);
+			}
+		};
+
+		for (auto& entry : _output_bdds) {
+			rebuild(entry.second);
+		}
+		for (auto& bdd : _bdds) {
+			rebuild(bdd);
+		}
 
-	for (auto& entry : _output_bdds) {
-		cout << "Rebuilding " << entry.first << endl;
-		entry.second = gr.rebuild(entry.second);
+		_rebuild_peak_nodes = source_mdd_forest->getCurrentNumNodes() + target_mdd_forest->getPeakNumNodes();
+		_rebuild_peak_memory = source_mdd_forest->getCurrentMemoryUsed() + target_mdd_forest->getPeakMemoryUsed();
+		num_roots = rebuilt.size();
 	}
 
+	// No edge refers to the source forest any more
+	MEDDLY::destroyForest(source_mdd_forest);
 	_mdd_forest = target_mdd_forest;
+
+	double end_time = get_cpu_time();
+	cout << "Rebuild: " << num_roots << " roots, " << (end_time - start_time) << " s" << endl;
+}
+
+void Rebuilder::output_status(ostream& out)
+{
+	ModelBuilder::output_status(out);
+	if (_rebuild_peak_nodes > 0) {
+		out << "Peak Node (Source + Target): " << _rebuild_peak_nodes << endl;
+		out << "Peak Memory (Source + Target): " << _rebuild_peak_memory << endl;
+	}
 }
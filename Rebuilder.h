@@ -7,9 +7,22 @@
 
 class Rebuilder : public ModelBuilder
 {
+protected:
+	// Nodes and memory held by the source and target forests together during the last rebuild
+	long _rebuild_peak_nodes;
+	long _rebuild_peak_memory;
+
 public:
 	Rebuilder(const Model& model);
 	virtual void reorder(int* order);
+	virtual void output_status(ostream& out);
+
+	long rebuild_peak_nodes() const;
 };
 
+inline long Rebuilder::rebuild_peak_nodes() const
+{
+	return _rebuild_peak_nodes;
+}
+
 #endif
@@ -0,0 +1,148 @@
+#include <cstring>
+#include <algorithm>
+#include <random>
+
+#include "ReorderBenchmark.h"
+#include "System.h"
+
+const char* ReorderBenchmark::METHOD_NAMES[ReorderBenchmark::NUM_METHODS] = {"IN_PLACE", "REBUILD"};
+
+ReorderBenchmark::ReorderBenchmark(Rebuilder& builder, unsigned seed, const char* target)
+	: _builder(builder), _seed(seed), _target(target)
+{
+	_original_order.assign(_builder.num_vars() + 1, 0);
+	_builder.get_variable_order(_original_order.data());
+}
+
+void ReorderBenchmark::target_order(int trial, int* order)
+{
+	int num_vars = _builder.num_vars();
+	if (strcmp(_target, "RANDOM") == 0) {
+		default_random_engine engine(_seed + trial);
+		std::copy(_original_order.begin(), _original_order.end(), order);
+		std::shuffle(&order[1], &order[num_vars + 1], engine);
+		return;
+	}
+
+	// The heuristics break ties randomly and place only the inputs in the cones of the outputs
+	ModelBuilder::seed(_seed + trial);
+	std::fill_n(order, num_vars + 1, 0);
+	if (strcmp(_target, "DFS") == 0) {
+		_builder.dfs_order(order);
+	}
+	else {
+		_builder.fanin_order(order);
+	}
+
+	// Keep the variables the heuristic placed, once each, and append the others
+	vector<bool> placed(num_vars + 1, false);
+	int last = 1;
+	for (int i = 1; i <= num_vars && order[i] != 0; i++) {
+		if (order[i] > 0 && order[i] <= num_vars && !placed[order[i]]) {
+			placed[order[i]] = true;
+			order[last++] = order[i];
+		}
+	}
+	for (int i = 1; i <= num_vars; i++) {
+		if (!placed[_original_order[i]]) {
+			order[last++] = _original_order[i];
+		}
+	}
+	order[0] = 0;
+}
+
+void ReorderBenchmark::restore()
+{
+	vector<int> order(_original_order);
+	_builder.ModelBuilder::reorder(order.data());
+}
+
+void ReorderBenchmark::run(int first, int last, vector<ReorderTrial>& trials)
+{
+	vector<int> order(_builder.num_vars() + 1);
+	for (int trial = first; trial < last; trial++) {
+		target_order(trial, order.data());
+
+		for (int method = 0; method < NUM_METHODS; method++) {
+			// Both reorder implementations may modify the order they are given
+			vector<int> target(order);
+
+			double start_time = get_cpu_time();
+			if (method == IN_PLACE) {
+				_builder.ModelBuilder::reorder(target.data());
+			}
+			else {
+				_builder.Rebuilder::reorder(target.data());
+			}
+			double end_time = get_cpu_time();
+
+			ReorderTrial result;
+			result.trial = trial;
+			result.method = method;
+			result.time = end_time - start_time;
+			result.peak_nodes = method == IN_PLACE ? _builder.peak_num_nodes() : _builder.rebuild_peak_nodes();
+			result.num_nodes = _builder.num_nodes();
+			trials.push_back(result);
+
+			restore();
+		}
+	}
+}
+
+void ReorderBenchmark::write_trials(const vector<ReorderTrial>& trials, ostream& out)
+{
+	out << "Trial\tMethod\tTime(s)\tPeakNodes\tNodes" << endl;
+	for (const auto& trial : trials) {
+		out << trial.trial << "\t" << METHOD_NAMES[trial.method] << "\t" << trial.time << "\t"
+				<< trial.peak_nodes << "\t" << trial.num_nodes << endl;
+	}
+}
+
+template <typename T>
+static T percentile(const vector<T>& sorted, int p)
+{
+	// Nearest rank
+	size_t rank = (p * sorted.size() + 99) / 100;
+	return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+void ReorderBenchmark::summarize(const vector<ReorderTrial>& trials, ostream& out)
+{
+	static const int PERCENTILES[] = {0, 50, 90, 100};
+
+	out << "Method\tTrials\tMetric\tMin\tP50\tP90\tMax" << endl;
+	for (int method = 0; method < NUM_METHODS; method++) {
+		vector<double> times;
+		vector<long> peaks;
+		vector<long> nodes;
+		for (const auto& trial : trials) {
+			if (trial.method == method) {
+				times.push_back(trial.time);
+				peaks.push_back(trial.peak_nodes);
+				nodes.push_back(trial.num_nodes);
+			}
+		}
+		if (times.empty()) {
+			continue;
+		}
+		std::sort(times.begin(), times.end());
+		std::sort(peaks.begin(), peaks.end());
+		std::sort(nodes.begin(), nodes.end());
+
+		out << METHOD_NAMES[method] << "\t" << times.size() << "\tTime(s)";
+		for (const auto& p : PERCENTILES) {
+			out << "\t" << percentile(times, p);
+		}
+		out << endl;
+		out << METHOD_NAMES[method] << "\t" << peaks.size() << "\tPeakNodes";
+		for (const auto& p : PERCENTILES) {
+			out << "\t" << percentile(peaks, p);
+		}
+		out << endl;
+		out << METHOD_NAMES[method] << "\t" << nodes.size() << "\tNodes";
+		for (const auto& p : PERCENTILES) {
+			out << "\t" << percentile(nodes, p);
+		}
+		out << endl;
+	}
+}
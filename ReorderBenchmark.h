@@ -0,0 +1,49 @@
+#ifndef REORDERBENCHMARK_H_
+#define REORDERBENCHMARK_H_
+
+#include <iostream>
+#include <vector>
+
+#include "Rebuilder.h"
+
+using namespace std;
+
+// One measured reordering
+struct ReorderTrial
+{
+	int trial;
+	int method;
+	double time;
+	long peak_nodes;
+	long num_nodes;
+};
+
+// Reorders the built BDDs to a sequence of target orders, in place and by rebuilding,
+// restoring the starting order before every measurement
+class ReorderBenchmark
+{
+public:
+	enum Method {IN_PLACE, REBUILD, NUM_METHODS};
+	static const char* METHOD_NAMES[NUM_METHODS];
+
+private:
+	Rebuilder& _builder;
+	unsigned _seed;
+	// RANDOM, DFS or FANIN
+	const char* _target;
+	vector<int> _original_order;
+
+	void target_order(int trial, int* order);
+	void restore();
+
+public:
+	ReorderBenchmark(Rebuilder& builder, unsigned seed, const char* target);
+
+	// Run the trials in [first, last); every trial depends only on the seed and its index
+	void run(int first, int last, vector<ReorderTrial>& trials);
+
+	static void write_trials(const vector<ReorderTrial>& trials, ostream& out);
+	static void summarize(const vector<ReorderTrial>& trials, ostream& out);
+};
+
+#endif
@@ -0,0 +1,302 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include <meddly.h>
+#include <meddly_expert.h>
+
+#include "SequentialModelBuilder.h"
+#include "System.h"
+
+const long SequentialModelBuilder::CLUSTER_NODE_LIMIT;
+
+SequentialModelBuilder::SequentialModelBuilder(const Model& model)
+	: ModelBuilder(model), _mxd_forest(nullptr), _peak_product_nodes(0)
+{
+}
+
+void SequentialModelBuilder::create_vars()
+{
+	// Latch outputs are state variables placed above the primary inputs
+	for (size_t i = 0; i < _model.latches().size(); i++) {
+		_vars.emplace(get_name(_model.latches()[i].output()).to_string(), latch_var(i));
+	}
+	ModelBuilder::create_vars();
+}
+
+void SequentialModelBuilder::collect_targets(vector<string>& targets) const
+{
+	ModelBuilder::collect_targets(targets);
+	for (const auto& latch : _model.latches()) {
+		targets.push_back(latch.input());
+	}
+}
+
+void SequentialModelBuilder::store_bdds()
+{
+	ModelBuilder::store_bdds();
+
+	_next_state_bdds.clear();
+	for (const auto& latch : _model.latches()) {
+		_next_state_bdds.push_back(get_bdd(latch.input()));
+	}
+}
+
+void SequentialModelBuilder::build_transition_relation()
+{
+	cout << "Building Transition Relation..." << endl;
+	double start_time = get_cpu_time();
+
+	MEDDLY::forest::policies p(true);
+	_mxd_forest = _domain->createForest(true, MEDDLY::forest::BOOLEAN, MEDDLY::forest::MULTI_TERMINAL, p);
+
+	// Same variable order as the MDD forest
+	int* order = new int[num_vars() + 1];
+	order[0] = 0;
+	static_cast<MEDDLY::expert_forest*>(_mdd_forest)->getVariableOrder(order);
+	static_cast<MEDDLY::expert_forest*>(_mxd_forest)->reorderVariables(order);
+	delete[] order;
+
+	MEDDLY::dd_edge all(_mdd_forest);
+	_mdd_forest->createEdge(true, all);
+
+	const bool POS_TERMS[] = {false, true};
+	const bool NEG_TERMS[] = {true, false};
+
+	// Conjuncts ordered by the top level of their next-state function, so that each
+	// cluster gathers latches with similar support
+	vector<size_t> latches(_next_state_bdds.size());
+	for (size_t i = 0; i < latches.size(); i++) {
+		latches[i] = i;
+	}
+	std::stable_sort(latches.begin(), latches.end(), [this](size_t x, size_t y) {
+		return _next_state_bdds[x].getLevel() < _next_state_bdds[y].getLevel();
+	});
+
+	_partitions.clear();
+	long partition_nodes = 0;
+	for (const auto& i : latches) {
+		MEDDLY::dd_edge next(_mxd_forest);
+		_mxd_forest->createEdgeForVar(latch_var(i), true, POS_TERMS, next);
+		MEDDLY::dd_edge not_next(_mxd_forest);
+		_mxd_forest->createEdgeForVar(latch_var(i), true, NEG_TERMS, not_next);
+
+		MEDDLY::dd_edge not_f(_mdd_forest);
+		MEDDLY::apply(MEDDLY::COMPLEMENT, _next_state_bdds[i], not_f);
+
+		// x'_i <-> f_i(x)
+		MEDDLY::dd_edge on(_mxd_forest);
+		MEDDLY::apply(MEDDLY::CROSS, _next_state_bdds[i], all, on);
+		MEDDLY::apply(MEDDLY::INTERSECTION, on, next, on);
+		MEDDLY::dd_edge off(_mxd_forest);
+		MEDDLY::apply(MEDDLY::CROSS, not_f, all, off);
+		MEDDLY::apply(MEDDLY::INTERSECTION, off, not_next, off);
+		MEDDLY::apply(MEDDLY::UNION, on, off, on);
+
+		_partitions.push_back(on);
+		partition_nodes += on.getNodeCount();
+	}
+
+	// Clusters grow until the next conjunct would take them over the limit
+	_clusters.clear();
+	long cluster_nodes = 0;
+	MEDDLY::dd_edge cluster(_mxd_forest);
+	_mxd_forest->createEdge(true, cluster);
+	int cluster_size = 0;
+	for (const auto& partition : _partitions) {
+		MEDDLY::dd_edge product(_mxd_forest);
+		MEDDLY::apply(MEDDLY::INTERSECTION, cluster, partition, product);
+		if (cluster_size > 0 && product.getNodeCount() > CLUSTER_NODE_LIMIT) {
+			_clusters.push_back(cluster);
+			cluster_nodes += cluster.getNodeCount();
+			cluster = partition;
+			cluster_size = 1;
+		}
+		else {
+			cluster = product;
+			cluster_size++;
+		}
+	}
+	if (cluster_size > 0) {
+		_clusters.push_back(cluster);
+		cluster_nodes += cluster.getNodeCount();
+	}
+	_relation = MEDDLY::dd_edge();
+
+	double end_time = get_cpu_time();
+	cout << "# Partitions: " << _partitions.size() << " (" << partition_nodes << " nodes)" << endl;
+	cout << "# Clusters: " << _clusters.size() << " (" << cluster_nodes << " nodes, limit " << CLUSTER_NODE_LIMIT << ")" << endl;
+	cout << (end_time - start_time) << " s" << endl;
+}
+
+void SequentialModelBuilder::build_monolithic_relation()
+{
+	double start_time = get_cpu_time();
+
+	_relation = MEDDLY::dd_edge(_mxd_forest);
+	_mxd_forest->createEdge(true, _relation);
+	for (const auto& cluster : _clusters) {
+		MEDDLY::apply(MEDDLY::INTERSECTION, _relation, cluster, _relation);
+	}
+
+	double end_time = get_cpu_time();
+	cout << "Relation Node: " << _relation.getNodeCount() << " (monolithic, " << (end_time - start_time) << " s)" << endl;
+}
+
+MEDDLY::dd_edge SequentialModelBuilder::image(const MEDDLY::dd_edge& states)
+{
+	// There is no early quantification: MEDDLY offers no existential abstraction of
+	// single levels, and POST_IMAGE quantifies all current-state levels at once. Every
+	// image therefore conjoins the states with each cluster in turn, building the
+	// relation restricted to the states, and quantifies once at the end. What it saves
+	// over the monolithic relation is only the part outside the states.
+	MEDDLY::dd_edge all(_mdd_forest);
+	_mdd_forest->createEdge(true, all);
+	MEDDLY::dd_edge product(_mxd_forest);
+	MEDDLY::apply(MEDDLY::CROSS, states, all, product);
+	for (const auto& cluster : _clusters) {
+		MEDDLY::apply(MEDDLY::INTERSECTION, product, cluster, product);
+		_peak_product_nodes = std::max(_peak_product_nodes, product.getNodeCount());
+	}
+
+	MEDDLY::dd_edge result(_mdd_forest);
+	MEDDLY::apply(MEDDLY::POST_IMAGE, states, product, result);
+	return result;
+}
+
+MEDDLY::dd_edge SequentialModelBuilder::initial_states()
+{
+	MEDDLY::dd_edge states(_mdd_forest);
+	_mdd_forest->createEdge(true, states);
+
+	for (size_t i = 0; i < _model.latches().size(); i++) {
+		const bool init = _model.latches()[i].init_value();
+		const bool terms[] = {!init, init};
+		MEDDLY::dd_edge literal(_mdd_forest);
+		_mdd_forest->createEdgeForVar(latch_var(i), false, terms, literal);
+		MEDDLY::apply(MEDDLY::INTERSECTION, states, literal, states);
+	}
+
+	return states;
+}
+
+double SequentialModelBuilder::count_states(const MEDDLY::dd_edge& states) const
+{
+	// Inputs and unused variables are unconstrained in every state set
+	return std::ldexp(states.getCardinality(), -(num_vars() - static_cast<int>(_model.latches().size())));
+}
+
+MEDDLY::dd_edge SequentialModelBuilder::reach_bfs()
+{
+	MEDDLY::dd_edge reached = initial_states();
+	MEDDLY::dd_edge frontier = reached;
+	MEDDLY::dd_edge empty(_mdd_forest);
+	_mdd_forest->createEdge(false, empty);
+
+	_peak_product_nodes = 0;
+	int iteration = 0;
+	while (frontier != empty) {
+		iteration++;
+		double iteration_start_time = get_cpu_time();
+
+		MEDDLY::dd_edge successors = image(frontier);
+		MEDDLY::apply(MEDDLY::DIFFERENCE, successors, reached, frontier);
+		MEDDLY::apply(MEDDLY::UNION, reached, frontier, reached);
+
+		double iteration_end_time = get_cpu_time();
+		cout << "Iteration " << iteration << ": " << count_states(reached) << " states, "
+				<< reached.getNodeCount() << " nodes, "
+				<< (iteration_end_time - iteration_start_time) << " s" << endl;
+	}
+	cout << "# Iterations: " << iteration << endl;
+	cout << "Peak Product Node: " << _peak_product_nodes << endl;
+
+	return reached;
+}
+
+MEDDLY::dd_edge SequentialModelBuilder::reach_saturation()
+{
+	// Saturation fires the events of a pregen_relation as a union, so one event per
+	// conjunct would explore the interleaving of single latch updates, not the
+	// synchronous steps. Saturation therefore takes the monolithic relation, built
+	// beforehand, and splits it into one event per top level.
+	assert(_relation.getForest() != nullptr);
+	MEDDLY::satpregen_opname::pregen_relation* events =
+			new MEDDLY::satpregen_opname::pregen_relation(_mdd_forest, _mxd_forest, _mdd_forest);
+	events->addToRelation(_relation);
+	events->finalize(MEDDLY::satpregen_opname::pregen_relation::MonolithicSplit);
+
+	MEDDLY::specialized_operation* saturation = MEDDLY::SATURATION_FORWARD->buildOperation(events);
+	MEDDLY::dd_edge reached(_mdd_forest);
+	saturation->compute(initial_states(), reached);
+	MEDDLY::destroyOperation(saturation);
+	delete events;
+
+	return reached;
+}
+
+void SequentialModelBuilder::compute_reachable_states(const char* method)
+{
+	if (_mxd_forest == nullptr) {
+		build_transition_relation();
+	}
+
+	const bool bfs = strcmp(method, "BFS") == 0 || strcmp(method, "BOTH") == 0;
+	const bool saturation = strcmp(method, "SAT") == 0 || strcmp(method, "BOTH") == 0;
+
+	double bfs_time = 0;
+	long bfs_peak = 0;
+	long bfs_relation_peak = 0;
+	if (bfs) {
+		cout << "Computing Reachable States (BFS)..." << endl;
+		_mdd_forest->resetPeakNumNodes();
+		_mxd_forest->resetPeakNumNodes();
+		double start_time = get_cpu_time();
+		MEDDLY::dd_edge reached = reach_bfs();
+		bfs_time = get_cpu_time() - start_time;
+		bfs_peak = _mdd_forest->getPeakNumNodes();
+		bfs_relation_peak = _mxd_forest->getPeakNumNodes();
+		cout << "Reachable States: " << count_states(reached) << endl;
+		cout << "Peak Node: " << bfs_peak << endl;
+		cout << "Peak Relation Node: " << bfs_relation_peak << endl;
+		cout << bfs_time << " s" << endl;
+	}
+
+	double saturation_time = 0;
+	long saturation_peak = 0;
+	long saturation_relation_peak = 0;
+	if (saturation) {
+		cout << "Computing Reachable States (Saturation)..." << endl;
+		// The relation is built outside the timing, as BFS never builds it
+		if (_relation.getForest() == nullptr) {
+			build_monolithic_relation();
+		}
+		_mdd_forest->resetPeakNumNodes();
+		_mxd_forest->resetPeakNumNodes();
+		double start_time = get_cpu_time();
+		MEDDLY::dd_edge reached = reach_saturation();
+		saturation_time = get_cpu_time() - start_time;
+		saturation_peak = _mdd_forest->getPeakNumNodes();
+		saturation_relation_peak = _mxd_forest->getPeakNumNodes();
+		cout << "Reachable States: " << count_states(reached) << endl;
+		cout << "Peak Node: " << saturation_peak << endl;
+		cout << "Peak Relation Node: " << saturation_relation_peak << endl;
+		cout << saturation_time << " s" << endl;
+	}
+
+	if (bfs && saturation) {
+		cout << "\nMethod\tTime (s)\tPeak Node\tPeak Relation Node" << endl;
+		cout << "BFS\t" << bfs_time << "\t" << bfs_peak << "\t" << bfs_relation_peak << endl;
+		cout << "SAT\t" << saturation_time << "\t" << saturation_peak << "\t" << saturation_relation_peak << endl;
+	}
+}
+
+void SequentialModelBuilder::clean_up()
+{
+	_partitions.clear();
+	_clusters.clear();
+	_next_state_bdds.clear();
+	_relation = MEDDLY::dd_edge();
+	ModelBuilder::clean_up();
+	_mxd_forest = nullptr;
+}
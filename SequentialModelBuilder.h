@@ -0,0 +1,67 @@
+#ifndef SEQUENTIALMODELBUILDER_H_
+#define SEQUENTIALMODELBUILDER_H_
+
+#include <vector>
+#include <meddly.h>
+
+#include "ModelBuilder.h"
+
+// Builds the next-state functions of the latches as well as the outputs,
+// and computes the reachable states symbolically.
+// Latch outputs are the variables right above the primary inputs; MEDDLY
+// interleaves their next-state copies level by level in the relation forest.
+class SequentialModelBuilder : public ModelBuilder
+{
+protected:
+	// Largest cluster of conjuncts, in nodes, unless a single conjunct is larger
+	static const long CLUSTER_NODE_LIMIT = 10000;
+
+	MEDDLY::forest* _mxd_forest;
+	// Next-state function of every latch over the current state and inputs
+	vector<MEDDLY::dd_edge> _next_state_bdds;
+	// One conjunct x'_i <-> f_i(x) per latch, ordered by the support of f_i
+	vector<MEDDLY::dd_edge> _partitions;
+	// Consecutive conjuncts conjoined up to the node limit
+	vector<MEDDLY::dd_edge> _clusters;
+	// Conjunction of all clusters, built only for saturation
+	MEDDLY::dd_edge _relation;
+	// Largest product of the frontier and the clusters during the last BFS
+	long _peak_product_nodes;
+
+	void build_monolithic_relation();
+	MEDDLY::dd_edge image(const MEDDLY::dd_edge& states);
+
+	virtual void collect_targets(vector<string>& targets) const;
+	virtual void store_bdds();
+
+	int latch_var(int latch) const;
+	MEDDLY::dd_edge initial_states();
+	double count_states(const MEDDLY::dd_edge& states) const;
+
+	MEDDLY::dd_edge reach_bfs();
+	MEDDLY::dd_edge reach_saturation();
+
+public:
+	SequentialModelBuilder(const Model& model);
+
+	virtual void create_vars();
+	virtual int actual_num_vars() const;
+
+	void build_transition_relation();
+	// Method: BFS (image loop), SAT (saturation) or BOTH for a comparison
+	void compute_reachable_states(const char* method);
+
+	virtual void clean_up();
+};
+
+inline int SequentialModelBuilder::latch_var(int latch) const
+{
+	return _model.inputs().size() + 1 + latch;
+}
+
+inline int SequentialModelBuilder::actual_num_vars() const
+{
+	return _model.inputs().size() + _model.latches().size();
+}
+
+#endif
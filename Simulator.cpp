@@ -0,0 +1,292 @@
+#include <cassert>
+#include <algorithm>
+
+#include "Simulator.h"
+
+const int Simulator::NUM_WORDS;
+const int Simulator::NUM_PATTERNS;
+
+Simulator::Simulator(const Model& model)
+	: _model(model), _num_signals(0), _num_patterns(0)
+{
+	for (const auto& input : _model.inputs()) {
+		get_or_add_signal(input);
+	}
+	for (const auto& latch : _model.latches()) {
+		get_or_add_signal(latch.output());
+	}
+
+	vector<const Gate*> drivers;
+	for (const auto& gate : _model.gates()) {
+		for (const auto& input : gate.inputs()) {
+			get_or_add_signal(input);
+		}
+		int output = get_or_add_signal(gate.name());
+		drivers.resize(_num_signals + 1, nullptr);
+		drivers[output] = &gate;
+	}
+	drivers.resize(_num_signals + 1, nullptr);
+
+	for (int i = 1; i <= _num_signals; i++) {
+		if (drivers[i] == nullptr) {
+			_free_signals.push_back(i);
+		}
+	}
+
+	// 0: not visited, 1: on the stack, 2: compiled
+	vector<int> visited(_num_signals + 1, 0);
+	_drivers.assign(_num_signals + 1, -1);
+	_levels.assign(_num_signals + 1, 0);
+	_cubes.push_back(0);
+	for (const auto& gate : _model.gates()) {
+		compile(&gate, drivers, visited);
+	}
+
+	_slots.resize(_num_signals + 1);
+	for (int i = 0; i <= _num_signals; i++) {
+		_slots[i] = i;
+	}
+
+	_values.assign((_num_signals + 1) * NUM_WORDS, 0);
+	_ones.assign(_num_signals + 1, 0);
+	_toggles.assign(_num_signals + 1, 0);
+}
+
+int Simulator::get_or_add_signal(const string& name)
+{
+	const auto itr = _signals.find(name);
+	if (itr != _signals.end()) {
+		return itr->second;
+	}
+	_num_signals++;
+	_signals.emplace(name, _num_signals);
+	return _num_signals;
+}
+
+void Simulator::compile(const Gate* gate, const vector<const Gate*>& drivers, vector<int>& visited)
+{
+	int output = signal(gate->name());
+	if (visited[output] == 2) {
+		return;
+	}
+	assert(visited[output] == 0 && "Combinational cycle");
+	visited[output] = 1;
+
+	int level = 0;
+	for (const auto& input : gate->inputs()) {
+		int input_signal = signal(input);
+		if (drivers[input_signal] != nullptr) {
+			compile(drivers[input_signal], drivers, visited);
+		}
+		level = std::max(level, _levels[input_signal]);
+	}
+	_levels[output] = level + 1;
+	_drivers[output] = _gates.size();
+
+	CompiledGate compiled;
+	compiled.output = output;
+	compiled.complement = gate->output()[0] == '-';
+	compiled.constant = gate->is_constant() && gate->constant();
+	compiled.cube_begin = _cubes.size() - 1;
+	if (!gate->is_constant()) {
+		for (const auto& row : gate->rows()) {
+			for (const auto& literal : row) {
+				if (literal[0] == '-') {
+					_literals.push_back(2 * signal(literal.substr(1)) + 1);
+				}
+				else {
+					_literals.push_back(2 * signal(literal));
+				}
+			}
+			_cubes.push_back(_literals.size());
+		}
+	}
+	compiled.cube_end = _cubes.size() - 1;
+	_gates.push_back(compiled);
+
+	visited[output] = 2;
+}
+
+void Simulator::seed(unsigned seed)
+{
+	_engine.seed(seed);
+}
+
+void Simulator::randomize()
+{
+	for (const auto& signal : _free_signals) {
+		word* values = &_values[signal * NUM_WORDS];
+		for (int w = 0; w < NUM_WORDS; w++) {
+			values[w] = _engine();
+		}
+	}
+}
+
+void Simulator::set_input(int signal, const word* values)
+{
+	std::copy(values, values + NUM_WORDS, &_values[signal * NUM_WORDS]);
+}
+
+void Simulator::evaluate(const CompiledGate& gate, const vector<int>& slots, vector<word>& values, int num_words) const
+{
+	word* out = &values[slots[gate.output] * num_words];
+	if (gate.cube_begin == gate.cube_end) {
+		// Constant, or a cover without rows
+		std::fill_n(out, num_words, gate.constant ? ~word(0) : word(0));
+		return;
+	}
+
+	const word mask = gate.complement ? ~word(0) : word(0);
+	for (int base = 0; base < num_words; base += NUM_WORDS) {
+		const int n = std::min(NUM_WORDS, num_words - base);
+
+		word acc[NUM_WORDS] = {};
+		for (int c = gate.cube_begin; c < gate.cube_end; c++) {
+			word cube[NUM_WORDS];
+			std::fill_n(cube, NUM_WORDS, ~word(0));
+			for (int l = _cubes[c]; l < _cubes[c + 1]; l++) {
+				const word* in = &values[slots[_literals[l] >> 1] * num_words + base];
+				const word literal_mask = (_literals[l] & 1) ? ~word(0) : word(0);
+				for (int w = 0; w < n; w++) {
+					cube[w] &= in[w] ^ literal_mask;
+				}
+			}
+			for (int w = 0; w < NUM_WORDS; w++) {
+				acc[w] |= cube[w];
+			}
+		}
+
+		for (int w = 0; w < n; w++) {
+			out[base + w] = acc[w] ^ mask;
+		}
+	}
+}
+
+void Simulator::simulate()
+{
+	for (const auto& gate : _gates) {
+		evaluate(gate, _slots, _values, NUM_WORDS);
+	}
+
+	accumulate();
+}
+
+void Simulator::accumulate()
+{
+	for (int i = 1; i <= _num_signals; i++) {
+		const word* values = &_values[i * NUM_WORDS];
+		for (int w = 0; w < NUM_WORDS; w++) {
+			_ones[i] += __builtin_popcountll(values[w]);
+
+			word shifted = values[w] >> 1;
+			if (w + 1 < NUM_WORDS) {
+				shifted |= values[w + 1] << 63;
+			}
+			word toggles = values[w] ^ shifted;
+			if (w + 1 == NUM_WORDS) {
+				// The last pattern has no successor
+				toggles &= ~(word(1) << 63);
+			}
+			_toggles[i] += __builtin_popcountll(toggles);
+		}
+	}
+	_num_patterns += NUM_PATTERNS;
+}
+
+void Simulator::reset_activity()
+{
+	_num_patterns = 0;
+	std::fill(_ones.begin(), _ones.end(), 0);
+	std::fill(_toggles.begin(), _toggles.end(), 0);
+}
+
+double Simulator::probability(int signal) const
+{
+	return _num_patterns == 0 ? 0.0 : static_cast<double>(_ones[signal]) / _num_patterns;
+}
+
+double Simulator::activity(int signal) const
+{
+	long rounds = _num_patterns / NUM_PATTERNS;
+	return rounds == 0 ? 0.0 : static_cast<double>(_toggles[signal]) / (rounds * (NUM_PATTERNS - 1));
+}
+
+double Simulator::correlation(int x, int y) const
+{
+	int agree = 0;
+	for (int w = 0; w < NUM_WORDS; w++) {
+		agree += __builtin_popcountll(~(_values[x * NUM_WORDS + w] ^ _values[y * NUM_WORDS + w]));
+	}
+	return 2.0 * agree / NUM_PATTERNS - 1.0;
+}
+
+void Simulator::collect_cone(int signal, vector<bool>& visited, vector<int>& gates, vector<int>& support) const
+{
+	if (visited[signal]) {
+		return;
+	}
+	visited[signal] = true;
+
+	int g = _drivers[signal];
+	if (g == -1) {
+		support.push_back(signal);
+		return;
+	}
+
+	const CompiledGate& gate = _gates[g];
+	for (int l = _cubes[gate.cube_begin]; l < _cubes[gate.cube_end]; l++) {
+		collect_cone(_literals[l] >> 1, visited, gates, support);
+	}
+	gates.push_back(g);
+}
+
+bool Simulator::prove_equivalent(int x, int y, bool complement, int max_support) const
+{
+	vector<bool> visited(_num_signals + 1, false);
+	vector<int> gates;
+	vector<int> support;
+	collect_cone(x, visited, gates, support);
+	collect_cone(y, visited, gates, support);
+	if (static_cast<int>(support.size()) > max_support) {
+		return false;
+	}
+
+	// One bit per assignment of the support
+	const int num_words = support.size() <= 6 ? 1 : (1 << (support.size() - 6));
+	vector<int> slots(_num_signals + 1, -1);
+	int num_slots = 0;
+	for (const auto& signal : support) {
+		slots[signal] = num_slots++;
+	}
+	for (const auto& g : gates) {
+		slots[_gates[g].output] = num_slots++;
+	}
+	vector<word> values(num_slots * num_words);
+
+	static const word PATTERNS[] = {
+		0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+		0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+	};
+	for (size_t i = 0; i < support.size(); i++) {
+		word* in = &values[slots[support[i]] * num_words];
+		for (int w = 0; w < num_words; w++) {
+			in[w] = i < 6 ? PATTERNS[i] : (((w >> (i - 6)) & 1) ? ~word(0) : word(0));
+		}
+	}
+
+	// Gates are numbered in topological order
+	std::sort(gates.begin(), gates.end());
+	for (const auto& g : gates) {
+		evaluate(_gates[g], slots, values, num_words);
+	}
+
+	const word mask = complement ? ~word(0) : word(0);
+	const word* vx = &values[slots[x] * num_words];
+	const word* vy = &values[slots[y] * num_words];
+	for (int w = 0; w < num_words; w++) {
+		if ((vx[w] ^ mask) != vy[w]) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,136 @@
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Model.h"
+
+using namespace std;
+
+// Bit-parallel simulator over the gates of a model.
+// Every signal carries NUM_WORDS 64-bit words, i.e. one round simulates
+// NUM_PATTERNS input patterns at once.
+class Simulator
+{
+public:
+	typedef uint64_t word;
+
+	static const int NUM_WORDS = 4;
+	static const int NUM_PATTERNS = NUM_WORDS * 64;
+
+private:
+	struct CompiledGate
+	{
+		int output;
+		bool complement;
+		bool constant;
+		// Cubes are [_cubes[cube_begin], _cubes[cube_end]) ranges of _literals
+		int cube_begin;
+		int cube_end;
+	};
+
+	const Model& _model;
+	mt19937_64 _engine;
+
+	unordered_map<string, int> _signals;
+	// Number of input, internal and output signals
+	int _num_signals;
+	// Signals without a driving gate: primary inputs, latch outputs and undriven wires
+	vector<int> _free_signals;
+
+	// Gates in topological order
+	vector<CompiledGate> _gates;
+	// Index into _gates of the driver of every signal, -1 for free signals
+	vector<int> _drivers;
+	// Logic level: 0 for free signals
+	vector<int> _levels;
+	// Slot of every signal in _values (the identity)
+	vector<int> _slots;
+	vector<int> _cubes;
+	// Literal = 2 * signal + complement
+	vector<int> _literals;
+
+	vector<word> _values;
+
+	// Accumulated activity over all simulated rounds
+	long _num_patterns;
+	vector<long> _ones;
+	vector<long> _toggles;
+
+	int get_or_add_signal(const string& name);
+	void compile(const Gate* gate, const vector<const Gate*>& drivers, vector<int>& visited);
+	void evaluate(const CompiledGate& gate, const vector<int>& slots, vector<word>& values, int num_words) const;
+	void accumulate();
+	void collect_cone(int signal, vector<bool>& visited, vector<int>& gates, vector<int>& support) const;
+
+public:
+	Simulator(const Model& model);
+
+	void seed(unsigned seed);
+	void randomize();
+	void set_input(int signal, const word* values);
+	void simulate();
+	void reset_activity();
+
+	int num_signals() const;
+	int signal(const string& name) const;
+	const vector<int>& free_signals() const;
+
+	const word* values(int signal) const;
+	bool value(int signal, int pattern) const;
+
+	// Fraction of simulated patterns for which the signal is 1
+	double probability(int signal) const;
+	// Fraction of consecutive pattern pairs for which the signal toggles
+	double activity(int signal) const;
+	// Agreement of two signals on the last round, scaled to [-1, 1]
+	double correlation(int x, int y) const;
+	long num_patterns() const;
+
+	int level(int signal) const;
+	// Exhaustively simulate the union support of two signals.
+	// Returns false if they differ or if the support exceeds max_support.
+	bool prove_equivalent(int x, int y, bool complement, int max_support) const;
+};
+
+inline int Simulator::num_signals() const
+{
+	return _num_signals;
+}
+
+inline int Simulator::signal(const string& name) const
+{
+	const auto itr = _signals.find(name);
+	return itr == _signals.end() ? 0 : itr->second;
+}
+
+inline const vector<int>& Simulator::free_signals() const
+{
+	return _free_signals;
+}
+
+inline const Simulator::word* Simulator::values(int signal) const
+{
+	return &_values[signal * NUM_WORDS];
+}
+
+inline bool Simulator::value(int signal, int pattern) const
+{
+	return (_values[signal * NUM_WORDS + pattern / 64] >> (pattern % 64)) & 1;
+}
+
+inline long Simulator::num_patterns() const
+{
+	return _num_patterns;
+}
+
+inline int Simulator::level(int signal) const
+{
+	return _levels[signal];
+}
+
+#endif
@@ -1,8 +1,63 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
 #include "System.h"
 
+#ifdef COUNT_ALLOCATIONS
+// Replaces the global operator new in benchmark builds only, as it slows down every allocation
+static std::atomic<long> num_allocations(0);
+
+void* operator new(size_t size)
+{
+	num_allocations.fetch_add(1, std::memory_order_relaxed);
+	void* p = malloc(size == 0 ? 1 : size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void operator delete(void* p) noexcept
+{
+	free(p);
+}
+#endif
+
 double get_cpu_time()
 {
 	struct rusage ru;
 	getrusage(RUSAGE_SELF, &ru);
 	return static_cast<double>(ru.ru_utime.tv_sec) + static_cast<double>(ru.ru_utime.tv_usec) / 1e6;
 }
+
+double get_wall_time()
+{
+	struct timeval tv;
+	gettimeofday(&tv, nullptr);
+	return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+long get_resident_memory()
+{
+	long size = 0;
+	long resident = 0;
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file != nullptr) {
+		if (fscanf(file, "%ld %ld", &size, &resident) != 2) {
+			resident = 0;
+		}
+		fclose(file);
+	}
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+long get_num_allocations()
+{
+#ifdef COUNT_ALLOCATIONS
+	return num_allocations.load(std::memory_order_relaxed);
+#else
+	return -1;
+#endif
+}
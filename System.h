@@ -6,5 +6,11 @@
 #include <unistd.h>
 
 double get_cpu_time();
+double get_wall_time();
+// Resident set size in bytes
+long get_resident_memory();
+// Calls to the global operator new since the start of the program, or -1 unless the
+// program was built with COUNT_ALLOCATIONS (make bench)
+long get_num_allocations();
 
 #endif
@@ -0,0 +1,172 @@
+#include <cassert>
+#include <unordered_map>
+
+#include "TruthTable.h"
+
+const int TruthTable::MAX_INPUTS;
+const int TruthTable::NUM_WORDS;
+const int ShannonRecipe::FALSE_OPERAND;
+const int ShannonRecipe::TRUE_OPERAND;
+
+TruthTable::TruthTable(int num_inputs)
+	: _num_inputs(num_inputs)
+{
+	assert(num_inputs <= MAX_INPUTS);
+	for (int w = 0; w < NUM_WORDS; w++) {
+		_bits[w] = 0;
+	}
+}
+
+TruthTable TruthTable::of_gate(const Gate& gate)
+{
+	const Gate::Signals& inputs = gate.inputs();
+	TruthTable table(inputs.size());
+
+	for (const auto& row : gate.rows()) {
+		// Inputs fixed by the cube and their values
+		int care = 0;
+		int value = 0;
+		for (const auto& literal : row) {
+			bool complement = literal[0] == '-';
+			size_t i = 0;
+			while (i < inputs.size() && literal.compare(complement ? 1 : 0, string::npos, inputs[i]) != 0) {
+				i++;
+			}
+			assert(i < inputs.size());
+			care |= 1 << i;
+			value |= complement ? 0 : 1 << i;
+		}
+		for (int a = 0; a < table.num_assignments(); a++) {
+			if ((a & care) == value) {
+				table.set(a);
+			}
+		}
+	}
+
+	return gate.output()[0] == '-' ? table.complement() : table;
+}
+
+bool TruthTable::is_false() const
+{
+	for (int w = 0; w < NUM_WORDS; w++) {
+		if (_bits[w] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool TruthTable::is_true() const
+{
+	return complement().is_false();
+}
+
+TruthTable TruthTable::complement() const
+{
+	TruthTable result(_num_inputs);
+	for (int a = 0; a < num_assignments(); a++) {
+		if (!get(a)) {
+			result.set(a);
+		}
+	}
+	return result;
+}
+
+TruthTable TruthTable::cofactor(int input, bool value) const
+{
+	// Still over all inputs, but independent of the given one
+	TruthTable result(_num_inputs);
+	int bit = 1 << input;
+	for (int a = 0; a < num_assignments(); a++) {
+		if (get(value ? (a | bit) : (a & ~bit))) {
+			result.set(a);
+		}
+	}
+	return result;
+}
+
+bool TruthTable::operator==(const TruthTable& other) const
+{
+	if (_num_inputs != other._num_inputs) {
+		return false;
+	}
+	for (int w = 0; w < NUM_WORDS; w++) {
+		if (_bits[w] != other._bits[w]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+size_t TruthTable::hash() const
+{
+	size_t hash = _num_inputs;
+	for (int w = 0; w < NUM_WORDS; w++) {
+		hash ^= std::hash<uint64_t>()(_bits[w]) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+	}
+	return hash;
+}
+
+// Operand of the subfunction, adding the steps it needs after those of its cofactors
+static int add_steps(const TruthTable& table, int top, vector<ShannonRecipe::Step>& steps,
+		unordered_map<TruthTable, int, TruthTableHash>& operands)
+{
+	if (table.is_false()) {
+		return ShannonRecipe::FALSE_OPERAND;
+	}
+	if (table.is_true()) {
+		return ShannonRecipe::TRUE_OPERAND;
+	}
+	const auto itr = operands.find(table);
+	if (itr != operands.end()) {
+		return itr->second;
+	}
+
+	// Expand on the highest input the function depends on
+	int input = top;
+	TruthTable high = table.cofactor(input, true);
+	TruthTable low = table.cofactor(input, false);
+	while (high == low) {
+		input--;
+		assert(input >= 0);
+		high = table.cofactor(input, true);
+		low = table.cofactor(input, false);
+	}
+
+	ShannonRecipe::Step step;
+	step.input = input;
+	step.high = add_steps(high, input - 1, steps, operands);
+	step.low = add_steps(low, input - 1, steps, operands);
+	steps.push_back(step);
+	operands.emplace(table, steps.size() - 1);
+	return steps.size() - 1;
+}
+
+ShannonRecipe::ShannonRecipe(const TruthTable& table)
+	: result(FALSE_OPERAND), num_applies(0)
+{
+	unordered_map<TruthTable, int, TruthTableHash> operands;
+	result = add_steps(table, table.num_inputs() - 1, steps, operands);
+
+	vector<bool> negated(table.num_inputs(), false);
+	for (const auto& step : steps) {
+		bool constant_high = step.high < 0;
+		bool constant_low = step.low < 0;
+		if (constant_high && constant_low) {
+			// The input itself, or its complement
+			negated[step.input] = negated[step.input] || step.high == FALSE_OPERAND;
+		}
+		else if (constant_high || constant_low) {
+			// One intersection or union with the input or its complement
+			num_applies++;
+			negated[step.input] = negated[step.input] || step.high == FALSE_OPERAND || step.low == TRUE_OPERAND;
+		}
+		else {
+			num_applies += 3;
+			negated[step.input] = true;
+		}
+	}
+	for (const auto& negate : negated) {
+		num_applies += negate;
+	}
+}
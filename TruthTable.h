@@ -0,0 +1,95 @@
+#ifndef TRUTHTABLE_H_
+#define TRUTHTABLE_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Gate.h"
+
+using namespace std;
+
+// Function of up to MAX_INPUTS inputs, one bit per assignment; input i is bit i of the assignment
+class TruthTable
+{
+public:
+	static const int MAX_INPUTS = 8;
+	static const int NUM_WORDS = (1 << MAX_INPUTS) / 64;
+
+private:
+	int _num_inputs;
+	uint64_t _bits[NUM_WORDS];
+
+public:
+	explicit TruthTable(int num_inputs = 0);
+
+	// Function of the cover of a gate over its inputs, including the complemented output
+	static TruthTable of_gate(const Gate& gate);
+
+	int num_inputs() const;
+	int num_assignments() const;
+	bool get(int assignment) const;
+	void set(int assignment);
+
+	bool is_false() const;
+	bool is_true() const;
+	TruthTable complement() const;
+	TruthTable cofactor(int input, bool value) const;
+
+	bool operator==(const TruthTable& other) const;
+	size_t hash() const;
+};
+
+struct TruthTableHash
+{
+	size_t operator()(const TruthTable& table) const
+	{
+		return table.hash();
+	}
+};
+
+// Shannon construction of a truth table over the BDDs of its inputs. Every step is
+// ite(input, high, low) on the results of earlier steps or the constants; shared
+// cofactors are built once.
+struct ShannonRecipe
+{
+	static const int FALSE_OPERAND = -1;
+	static const int TRUE_OPERAND = -2;
+
+	struct Step
+	{
+		int input;
+		int high;
+		int low;
+	};
+
+	vector<Step> steps;
+	// The last step or a constant
+	int result;
+	// Apply calls of the construction, counting complemented inputs once
+	int num_applies;
+
+	explicit ShannonRecipe(const TruthTable& table);
+};
+
+inline int TruthTable::num_inputs() const
+{
+	return _num_inputs;
+}
+
+inline int TruthTable::num_assignments() const
+{
+	return 1 << _num_inputs;
+}
+
+inline bool TruthTable::get(int assignment) const
+{
+	return (_bits[assignment >> 6] >> (assignment & 63)) & 1;
+}
+
+inline void TruthTable::set(int assignment)
+{
+	_bits[assignment >> 6] |= uint64_t(1) << (assignment & 63);
+}
+
+#endif